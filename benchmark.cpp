@@ -0,0 +1,171 @@
+/**
+ * Redfish is an open-source chess engine.
+ * Copyright (C) 2016 Arne Groskurth
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <array>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "src/Board.hpp"
+#include "src/Engine.hpp"
+#include "src/MoveGenerator.hpp"
+#include "src/TranspositionTable.hpp"
+
+using namespace std::chrono;
+
+
+/**
+ * Random occupancies the sliding piece attacks are looked up for.
+ */
+std::array<uint64_t, 4096> occupancies;
+
+
+/**
+ * Measures bishop and rook attack lookups per second with the attack tables filled for the given indexing.
+ */
+template<SliderIndexing sliderIndexing>
+void benchmarkSliderAttacks(const std::string &name) {
+
+    const uint64_t rounds = 100000;
+
+    MoveGenerator::initialize(sliderIndexing);
+
+    uint64_t checksum = 0;
+
+    high_resolution_clock::time_point t1 = high_resolution_clock::now();
+
+    for(uint64_t round = 0; round < rounds; round++) {
+
+        for(uint8_t sq8x8 = 0; sq8x8 < 64; sq8x8++) {
+
+            uint64_t occupiedMask8x8 = occupancies[(round * 64 + sq8x8) & 4095];
+
+            checksum ^= MoveGenerator::getBishopAttacks<sliderIndexing>(sq8x8, occupiedMask8x8);
+            checksum ^= MoveGenerator::getRookAttacks<sliderIndexing>(sq8x8, occupiedMask8x8);
+        }
+    }
+
+    high_resolution_clock::time_point t2 = high_resolution_clock::now();
+
+    double seconds = duration_cast<duration<double>>(t2 - t1).count();
+
+    std::cout << name << ": " << uint64_t(rounds * 64 * 2 / seconds) << " attacks/s (checksum " << std::hex << checksum << std::dec << ")" << std::endl;
+}
+
+
+/**
+ * Measures the time to search the given positions to a fixed depth with increasing numbers of threads and prints the
+ * speedup over a single thread. Every search starts with an empty transposition table.
+ */
+void benchmarkParallelSearch(const std::string &name, ParallelSearch parallelSearch, const std::vector<Board> &positions, const std::vector<uint8_t> &threadCounts) {
+
+    SearchLimits limits;
+    limits.depth = 14;
+
+    double singleThreadSeconds = 0;
+
+    for(uint8_t threads : threadCounts) {
+
+        uint64_t nodeCount = 0;
+
+        high_resolution_clock::time_point t1 = high_resolution_clock::now();
+
+        for(const Board &board : positions) {
+
+            TranspositionTable transpositionTable(16);
+            Engine<> engine(board, limits, transpositionTable, threads, parallelSearch);
+
+            engine.getBestMove();
+
+            nodeCount += engine.getNodeCount();
+        }
+
+        high_resolution_clock::time_point t2 = high_resolution_clock::now();
+
+        double seconds = duration_cast<duration<double>>(t2 - t1).count();
+
+        if(threads == 1) singleThreadSeconds = seconds;
+
+        std::cout << name << " " << int(threads) << " threads: " << uint64_t(seconds * 1000) << " ms, " << nodeCount << " nodes, speedup "
+            << (singleThreadSeconds / seconds) << std::endl;
+    }
+}
+
+
+int main() {
+
+    std::cout << mastHead;
+
+
+    std::mt19937_64 randomNumberEngine(0);
+
+    for(auto &occupiedMask8x8 : occupancies) {
+
+        occupiedMask8x8 = randomNumberEngine() & randomNumberEngine();
+    }
+
+
+    benchmarkSliderAttacks<SliderIndexing::MAGIC>("magic");
+
+    if(MoveGenerator::isPextSupported()) {
+
+        benchmarkSliderAttacks<SliderIndexing::PEXT>("pext");
+    }
+    else {
+
+        std::cout << "pext: not supported by this cpu" << std::endl;
+    }
+
+
+    MoveGenerator::initialize();
+
+    std::cout << "Selected at startup: " << ((MoveGenerator::getSliderIndexing() == SliderIndexing::PEXT) ? "pext" : "magic") << std::endl;
+
+
+    // start position and the positions reached after 10 and 20 plies of self-play
+    std::vector<Board> positions;
+    Board board;
+    board.reset();
+
+    SearchLimits limits;
+    limits.depth = 4;
+
+    for(uint8_t ply = 0; ply <= 20 && !board.isFinalState(); ply++) {
+
+        if(ply % 10 == 0) positions.push_back(board);
+
+        TranspositionTable transpositionTable(1);
+        Engine<> engine(board, limits, transpositionTable);
+
+        board.applyMove<true>(engine.getBestMove());
+    }
+
+    std::vector<uint8_t> threadCounts;
+
+    for(unsigned threads = 1; threads <= std::max(std::thread::hardware_concurrency(), 2u) && threads <= 64; threads *= 2) {
+
+        threadCounts.push_back(uint8_t(threads));
+    }
+
+    benchmarkParallelSearch("Lazy SMP", ParallelSearch::LAZY_SMP, positions, threadCounts);
+    benchmarkParallelSearch("YBWC", ParallelSearch::YBWC, positions, threadCounts);
+
+    return 0;
+}
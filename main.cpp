@@ -19,15 +19,14 @@
 #include <iostream>
 
 #include "src/Board.hpp"
-#include "src/SortedMoveGenerator.hpp"
+#include "src/MoveGenerator.hpp"
 
 
 int main() {
 
     std::cout << mastHead;
 
-    Board::initialize();
-    SortedMoveGenerator::initialize();
+    MoveGenerator::initialize();
 
 
     Board board;
@@ -36,7 +35,8 @@ int main() {
     std::cout << board;
 
 
-    MoveGenerator moveGenerator;
+    MoveGenerator::TMovesArray moves;
+    MoveGenerator moveGenerator(moves);
     moveGenerator.generateMoves(board);
 
 
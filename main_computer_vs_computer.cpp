@@ -16,28 +16,78 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
 #include <iostream>
+#include <vector>
 
 #include "src/Board.hpp"
 #include "src/Engine.hpp"
-#include "src/SortedMoveGenerator.hpp"
+#include "src/MoveGenerator.hpp"
+#include "src/Options.hpp"
+#include "src/SearchStats.hpp"
+#include "src/TranspositionTable.hpp"
 
 
-int main() {
+int main(int argc, char **argv) {
 
-    Board::initialize();
-    SortedMoveGenerator::initialize();
+    Options options;
+    options.parse(argc, argv);
+
+    MoveGenerator::initialize();
 
 
     Board board;
-    board.reset();
+
+    if(options.fen.empty()) {
+
+        board.reset();
+    }
+    else if(!board.setFen(options.fen)) {
+
+        std::cerr << "Invalid FEN: " << options.fen << std::endl;
+
+        return 1;
+    }
+
+    // the transposition table needs at least one megabyte, Hash=0 only disables the perft cache
+    TranspositionTable transpositionTable(std::max(options.hash, size_t(1)));
+
+    // nodes searched by each thread and search statistics of the last computer move
+    std::vector<uint64_t> nodeCounts;
+    SearchStats searchStats;
 
     while(!board.isFinalState()) {
 
         std::cout << "\x1B[2J\x1B[H" << mastHead << board;
 
-        Engine<> engine(board, 6);
+        std::cout << "Hash: " << (transpositionTable.getSize() >> 20) << " MB, " << (transpositionTable.getPageSize() >> 10) << " kB pages, " << transpositionTable.getFillRate() << " permille full" << std::endl;
+
+        if(!nodeCounts.empty()) {
+
+            std::cout << "Nodes per thread:";
+
+            for(uint64_t nodeCount : nodeCounts) {
+
+                std::cout << " " << nodeCount;
+            }
+
+            std::cout << std::endl << searchStats;
+        }
+
+        Engine<> engine(board, options.limits, transpositionTable, options.threads, options.parallelSearch);
+        Move move = engine.getBestMove();
+
+        if(move == Move(uint16_t(0))) {
+
+            std::cout << "No move possible" << std::endl;
+
+            break;
+        }
+
+        board.applyMove(move);
+
+        nodeCounts = engine.getThreadNodeCounts();
 
-        board.applyMove(engine.getBestMove());
+        searchStats = engine.getSearchStats();
     }
 }
\ No newline at end of file
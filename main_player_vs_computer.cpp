@@ -16,27 +16,51 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
 #include <iostream>
 #include <regex>
 #include <string>
+#include <vector>
 
 #include "src/Board.hpp"
 #include "src/Engine.hpp"
-#include "src/SortedMoveGenerator.hpp"
+#include "src/MoveGenerator.hpp"
+#include "src/Options.hpp"
+#include "src/SearchStats.hpp"
+#include "src/TranspositionTable.hpp"
 
 
-int main() {
+int main(int argc, char **argv) {
 
-    Board::initialize();
-    SortedMoveGenerator::initialize();
+    Options options;
+    options.parse(argc, argv);
+
+    MoveGenerator::initialize();
 
 
     Board board;
-    board.reset();
+
+    if(options.fen.empty()) {
+
+        board.reset();
+    }
+    else if(!board.setFen(options.fen)) {
+
+        std::cerr << "Invalid FEN: " << options.fen << std::endl;
+
+        return 1;
+    }
+
+    // the transposition table needs at least one megabyte, Hash=0 only disables the perft cache
+    TranspositionTable transpositionTable(std::max(options.hash, size_t(1)));
+
+    // nodes searched by each thread and search statistics of the last computer move
+    std::vector<uint64_t> nodeCounts;
+    SearchStats searchStats;
 
     std::string playerMoveString;
-    Move lastMove;
-    SortedMoveGenerator moveGenerator;
+    MoveGenerator::TMovesArray moves;
+    MoveGenerator moveGenerator(moves);
 
     std::regex expression("^([a-h][1-8]):([a-h][1-8])$");
     std::smatch expressionMatch;
@@ -46,9 +70,28 @@ int main() {
 
         std::cout << "\x1B[2J\x1B[H" << mastHead << board;
 
+        std::cout << "Hash: " << (transpositionTable.getSize() >> 20) << " MB, " << (transpositionTable.getPageSize() >> 10) << " kB pages, " << transpositionTable.getFillRate() << " permille full" << std::endl;
+
+        if(!nodeCounts.empty()) {
+
+            std::cout << "Nodes per thread:";
+
+            for(uint64_t nodeCount : nodeCounts) {
+
+                std::cout << " " << nodeCount;
+            }
+
+            std::cout << std::endl << searchStats;
+        }
+
         if(board.whiteToMove()) {
 
-            moveGenerator.generateMoves(board);
+            if(!moveGenerator.generateMoves(board)) {
+
+                std::cout << "No move possible" << std::endl;
+
+                break;
+            }
 
             Move playerMove;
 
@@ -69,11 +112,7 @@ int main() {
                     uint8_t toColumn = to[0] - 97;
                     uint8_t toRow = to[1] - 49;
 
-                    playerMove.fromSq0x88 = sq0x88ByRowAndColumn(fromRow, fromColumn);
-                    playerMove.toSq0x88 = sq0x88ByRowAndColumn(toRow, toColumn);
-
-                    playerMove.movingPieceType = board.getPieceBySq0x88(playerMove.fromSq0x88);
-                    playerMove.capturedPieceType = board.getPieceBySq0x88(playerMove.toSq0x88);
+                    playerMove = Move(sq8x8ByRowAndColumn(fromRow, fromColumn), sq8x8ByRowAndColumn(toRow, toColumn));
 
 
                     // break loop if valid move given
@@ -89,9 +128,21 @@ int main() {
 
             std::cout << "Calculating..." << std::flush;
 
-            Engine<> engine(board, 6);
+            Engine<> engine(board, options.limits, transpositionTable, options.threads, options.parallelSearch);
+            Move move = engine.getBestMove();
+
+            if(move == Move(uint16_t(0))) {
+
+                std::cout << "No move possible" << std::endl;
+
+                break;
+            }
+
+            board.applyMove(move);
+
+            nodeCounts = engine.getThreadNodeCounts();
 
-            board.applyMove(engine.getBestMove());
+            searchStats = engine.getSearchStats();
         }
     }
     while(!board.isFinalState());
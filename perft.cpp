@@ -0,0 +1,84 @@
+/**
+ * Redfish is an open-source chess engine.
+ * Copyright (C) 2016 Arne Groskurth
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <chrono>
+#include <iostream>
+
+#include "src/Board.hpp"
+#include "src/MoveGenerator.hpp"
+#include "src/Options.hpp"
+#include "src/Perft.hpp"
+
+using namespace std::chrono;
+
+
+/**
+ * Prints the leaf node count of every root move and the total for the given depth (Depth=), position (Fen=),
+ * threads (Threads=) and subtree count cache size in megabytes (Hash=, 0 disables the cache).
+ */
+int main(int argc, char **argv) {
+
+    Options options;
+    options.parse(argc, argv);
+
+    std::cout << mastHead;
+
+    MoveGenerator::initialize();
+
+
+    Board board;
+
+    if(options.fen.empty()) {
+
+        board.reset();
+    }
+    else if(!board.setFen(options.fen)) {
+
+        std::cerr << "Invalid FEN: " << options.fen << std::endl;
+
+        return 1;
+    }
+
+    std::cout << board;
+
+    Perft perft(options.hash);
+
+    high_resolution_clock::time_point t1 = high_resolution_clock::now();
+
+    auto results = perft.divide(board, options.limits.depth, options.threads);
+
+    high_resolution_clock::time_point t2 = high_resolution_clock::now();
+
+    uint64_t nodes = 0;
+
+    for(auto &result : results) {
+
+        std::cout << result.first << ": " << result.second << std::endl;
+
+        nodes += result.second;
+    }
+
+    double seconds = duration_cast<duration<double>>(t2 - t1).count();
+
+    std::cout << "Depth: " << int(options.limits.depth) << std::endl;
+    std::cout << "Nodes: " << nodes << std::endl;
+    std::cout << "Time: " << uint64_t(seconds * 1000) << " ms" << std::endl;
+    std::cout << "Nodes per second: " << uint64_t(nodes / seconds) << std::endl;
+
+    return 0;
+}
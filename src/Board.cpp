@@ -18,26 +18,110 @@
 
 #include "Board.hpp"
 
-#include <chrono>
-#include <cstring>
-#include <random>
+#include <algorithm>
+#include <sstream>
 
+#include "LookupTables.hpp"
 
-std::array<std::array<uint64_t, 13>, 64> Board::_hashTable;
 
+// constant expressions, emitted as initialized data
+const std::array<std::array<uint64_t, 13>, 64> Board::_hashTable = LookupTables::zobristTable();
+const uint64_t Board::_blackToMoveHash = LookupTables::blackToMoveKey();
 
-void Board::initialize() {
 
-    auto seed = std::chrono::system_clock::now().time_since_epoch().count();
-    std::mt19937_64 randomNumberEngine(seed);
+bool Board::setFen(const std::string &fen) {
 
-    std::memset(&_hashTable, 0, sizeof(_hashTable));
+    std::istringstream stream(fen);
+    std::string pieces, player, castling, enPassant;
+    uint64_t halfmoveClock = 0, fullmoveNumber = 1;
 
-    for(int i = 0; i < 64; i++) {
+    if(!(stream >> pieces >> player)) return false;
 
-        for(int j = 1; j < 13; j++) {
+    stream >> castling >> enPassant >> halfmoveClock >> fullmoveNumber;
 
-            _hashTable[i][j] = randomNumberEngine();
+    _bitboards.fill(0);
+    _mailbox.fill(PieceType::NONE);
+
+    // pieces are listed row by row from the 8th to the 1st row
+    int row = 7, column = 0;
+
+    for(char character : pieces) {
+
+        if(character == '/') {
+
+            if(column != 8 || row == 0) return false;
+
+            row--;
+            column = 0;
+        }
+        else if(character >= '1' && character <= '8') {
+
+            column += character - '0';
+
+            if(column > 8) return false;
+        }
+        else {
+
+            auto it = std::find_if(fenCharacters.begin(), fenCharacters.end(), [character](const std::pair<const PieceType, char> &entry) { return entry.second == character; });
+
+            if(it == fenCharacters.end() || column >= 8) return false;
+
+            PieceType piece = it->first;
+            uint64_t mask8x8 = mask8x8ByRowAndColumn(row, column);
+
+            _mailbox[sq8x8ByRowAndColumn(row, column)] = piece;
+            _bitboards[IS_WHITE(piece) * 7] |= mask8x8;
+            _bitboards[PIECE_TYPE(piece)] |= mask8x8;
+
+            column++;
         }
     }
-}
\ No newline at end of file
+
+    if(row != 0 || column != 8) return false;
+
+    // positions that cannot arise in a game are rejected, move generation relies on their limits
+    // (a king per player to be captured, the size of the moves array, no pawns without moves for lack of promotions)
+    for(uint64_t playerMask8x8 : {getWhiteMask(), getBlackMask()}) {
+
+        if(SET_BITS_64(playerMask8x8 & _bitboards[PieceType::KING]) != 1
+            || SET_BITS_64(playerMask8x8) > 16
+            || SET_BITS_64(playerMask8x8 & _bitboards[PieceType::PAWN]) > 8) {
+
+            return false;
+        }
+    }
+
+    if(_bitboards[PieceType::PAWN] & (mask8x8ByRow(0) | mask8x8ByRow(7))) return false;
+
+    if(player == "w") {
+
+        _player = Player::WHITE;
+    }
+    else if(player == "b") {
+
+        _player = Player::BLACK;
+    }
+    else {
+
+        return false;
+    }
+
+    // move numbers count plies
+    _moveNumber = uint32_t(2 * (std::max(fullmoveNumber, uint64_t(1)) - 1) + 1 + blackToMove());
+
+    // todo: castling flags
+    _bitfield = 0;
+
+    _enPassantSq8x8 = noEnPassantSq8x8;
+
+    if(enPassant.size() == 2 && enPassant[0] >= 'a' && enPassant[0] <= 'h' && enPassant[1] >= '1' && enPassant[1] <= '8') {
+
+        _enPassantSq8x8 = sq8x8ByRowAndColumn(enPassant[1] - '1', enPassant[0] - 'a');
+    }
+
+    _halfmoveClock = uint8_t(std::min(halfmoveClock, uint64_t(255)));
+
+    _hash = computeFullHash();
+
+    return true;
+}
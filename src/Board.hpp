@@ -22,28 +22,34 @@
 #include <cstdlib>
 #include <iostream>
 #include <string>
+#include <type_traits>
 
 #include "Constants.hpp"
 #include "Misc.hpp"
 #include "Move.hpp"
 #include "PositionMath.hpp"
+#include "Profiler.hpp"
 
 
-class Board {
+class alignas(64) Board {
 
 protected:
 
     // bitboard representation
     // [0] all black pieces
-    // [1-6] black piece types
+    // [1-6] piece types of both players (a player's pieces of a type are the intersection with its pieces)
     // [7] all white pieces
-    // [8-13] white piece types
-    // [14] occupied
-    // [15] not occupied
-    std::array<uint64_t, 16> _bitboards;
+    // occupied and not occupied fields are derived from [0] and [7]
+    std::array<uint64_t, 8> _bitboards;
 
-    // 0x88 representation
-    std::array<PieceType, 128> _0x88;
+    // mailbox representation indexed by sq8x8
+    std::array<PieceType, 64> _mailbox;
+
+    // board hash
+    uint64_t _hash;
+
+    // move number starting with 1
+    uint32_t _moveNumber;
 
     // player to move
     Player _player;
@@ -56,222 +62,378 @@ protected:
     // 4    black king in cheque
     uint8_t _bitfield;
 
-    // move number starting with 1
-    uint64_t _moveNumber;
+    // en passant target field as sq8x8 (noEnPassantSq8x8 if there is none)
+    // todo: en passant captures are not generated yet, so the field is only set up from FEN strings and cleared by moves
+    uint8_t _enPassantSq8x8;
 
-    // board hash
-    uint64_t _hash;
+    // plies since the last capture or pawn move (saturates at 255)
+    uint8_t _halfmoveClock;
 
 
-    // computes and sets board hash obtained with Zobrist hashing
-    FORCE_INLINE UNROLL_LOOPS void computeHash() {
+    // computes board hash obtained with Zobrist hashing from scratch
+    FORCE_INLINE UNROLL_LOOPS uint64_t computeFullHash() const {
 
-        _hash = 0;
+        uint64_t hash = 0;
 
         for(uint8_t sq8x8 = 0; sq8x8 < 64; sq8x8++) {
 
-            _hash ^= _hashTable[sq8x8][this->getPieceBySq8x8(sq8x8)];
+            hash ^= _hashTable[sq8x8][getPieceIndex(this->getPieceBySq8x8(sq8x8))];
         }
 
-        _hash ^= static_cast<uint64_t>(_player);
+        if(blackToMove()) hash ^= _blackToMoveHash;
+
+        return hash;
     }
 
 
-    // hash table
-    static std::array<std::array<uint64_t, 13>, 64> _hashTable;
+    // hash table with fixed keys so that hashes are equal on every run (see LookupTables)
+    // _hashTable[sq8x8][pieceIndex] - random keys per piece and field (zero for PieceType::NONE, see getPieceIndex())
+    // _blackToMoveHash - random key for the player to move
+    static const std::array<std::array<uint64_t, 13>, 64> _hashTable;
+    static const uint64_t _blackToMoveHash;
 
 
 public:
 
+    static const uint8_t noEnPassantSq8x8 = 64;
+
+
     /**
-     * Initialize hashTable
+     * State that cannot be recovered from a move when taking it back with unmakeMove().
      */
-    static void initialize();
+    struct Undo {
+
+        PieceType capturedPieceType;
+        uint8_t bitfield;
+        uint8_t enPassantSq8x8;
+        uint8_t halfmoveClock;
+        uint64_t hash;
+    };
 
 
     FORCE_INLINE Board() {}
-    FORCE_INLINE Board(const Board &other) {
-        
-        _bitboards = other._bitboards;
-        _0x88 = other._0x88;
-        _player = other._player;
-        _bitfield = other._bitfield;
-        _moveNumber = other._moveNumber;
-        _hash = other._hash;
-    }
+
+    // bitboards, mailbox and state fill three cache lines and are copied as a whole
+    FORCE_INLINE Board(const Board &other) = default;
 
     FORCE_INLINE uint64_t getWhiteMask() const { return _bitboards[7]; }
-    FORCE_INLINE uint64_t getWhitePawnsMask() const { return _bitboards[7 + PieceType::PAWN]; }
-    FORCE_INLINE uint64_t getWhiteKnightsMask() const { return _bitboards[7 + PieceType::KNIGHT]; }
-    FORCE_INLINE uint64_t getWhiteBishopsMask() const { return _bitboards[7 + PieceType::BISHOP]; }
-    FORCE_INLINE uint64_t getWhiteRooksMask() const { return _bitboards[7 + PieceType::ROOK]; }
-    FORCE_INLINE uint64_t getWhiteQueenMask() const { return _bitboards[7 + PieceType::QUEEN]; }
-    FORCE_INLINE uint64_t getWhiteKingMask() const { return _bitboards[7 + PieceType::KING]; }
+    FORCE_INLINE uint64_t getWhitePawnsMask() const { return _bitboards[7] & _bitboards[PieceType::PAWN]; }
+    FORCE_INLINE uint64_t getWhiteKnightsMask() const { return _bitboards[7] & _bitboards[PieceType::KNIGHT]; }
+    FORCE_INLINE uint64_t getWhiteBishopsMask() const { return _bitboards[7] & _bitboards[PieceType::BISHOP]; }
+    FORCE_INLINE uint64_t getWhiteRooksMask() const { return _bitboards[7] & _bitboards[PieceType::ROOK]; }
+    FORCE_INLINE uint64_t getWhiteQueenMask() const { return _bitboards[7] & _bitboards[PieceType::QUEEN]; }
+    FORCE_INLINE uint64_t getWhiteKingMask() const { return _bitboards[7] & _bitboards[PieceType::KING]; }
 
     FORCE_INLINE uint64_t getBlackMask() const { return _bitboards[0]; }
-    FORCE_INLINE uint64_t getBlackPawnsMask() const { return _bitboards[0 + PieceType::PAWN]; }
-    FORCE_INLINE uint64_t getBlackKnightsMask() const { return _bitboards[0 + PieceType::KNIGHT]; }
-    FORCE_INLINE uint64_t getBlackBishopsMask() const { return _bitboards[0 + PieceType::BISHOP]; }
-    FORCE_INLINE uint64_t getBlackRooksMask() const { return _bitboards[0 + PieceType::ROOK]; }
-    FORCE_INLINE uint64_t getBlackQueenMask() const { return _bitboards[0 + PieceType::QUEEN]; }
-    FORCE_INLINE uint64_t getBlackKingMask() const { return _bitboards[0 + PieceType::KING]; }
+    FORCE_INLINE uint64_t getBlackPawnsMask() const { return _bitboards[0] & _bitboards[PieceType::PAWN]; }
+    FORCE_INLINE uint64_t getBlackKnightsMask() const { return _bitboards[0] & _bitboards[PieceType::KNIGHT]; }
+    FORCE_INLINE uint64_t getBlackBishopsMask() const { return _bitboards[0] & _bitboards[PieceType::BISHOP]; }
+    FORCE_INLINE uint64_t getBlackRooksMask() const { return _bitboards[0] & _bitboards[PieceType::ROOK]; }
+    FORCE_INLINE uint64_t getBlackQueenMask() const { return _bitboards[0] & _bitboards[PieceType::QUEEN]; }
+    FORCE_INLINE uint64_t getBlackKingMask() const { return _bitboards[0] & _bitboards[PieceType::KING]; }
 
     FORCE_INLINE uint64_t getCurrentPlayerPiecesMask() const { return _bitboards[whiteToMove() * 7]; }
-    FORCE_INLINE uint64_t getCurrentPlayerPawnsMask() const { return _bitboards[whiteToMove() * 7 + PieceType::PAWN]; }
-    FORCE_INLINE uint64_t getCurrentPlayerKnightsMask() const { return _bitboards[whiteToMove() * 7 + PieceType::KNIGHT]; }
-    FORCE_INLINE uint64_t getCurrentPlayerBishopsMask() const { return _bitboards[whiteToMove() * 7 + PieceType::BISHOP]; }
-    FORCE_INLINE uint64_t getCurrentPlayerRooksMask() const { return _bitboards[whiteToMove() * 7 + PieceType::ROOK]; }
-    FORCE_INLINE uint64_t getCurrentPlayerQueenMask() const { return _bitboards[whiteToMove() * 7 + PieceType::QUEEN]; }
-    FORCE_INLINE uint64_t getCurrentPlayerKingMask() const { return _bitboards[whiteToMove() * 7 + PieceType::KING]; }
+    FORCE_INLINE uint64_t getCurrentPlayerPawnsMask() const { return _bitboards[whiteToMove() * 7] & _bitboards[PieceType::PAWN]; }
+    FORCE_INLINE uint64_t getCurrentPlayerKnightsMask() const { return _bitboards[whiteToMove() * 7] & _bitboards[PieceType::KNIGHT]; }
+    FORCE_INLINE uint64_t getCurrentPlayerBishopsMask() const { return _bitboards[whiteToMove() * 7] & _bitboards[PieceType::BISHOP]; }
+    FORCE_INLINE uint64_t getCurrentPlayerRooksMask() const { return _bitboards[whiteToMove() * 7] & _bitboards[PieceType::ROOK]; }
+    FORCE_INLINE uint64_t getCurrentPlayerQueenMask() const { return _bitboards[whiteToMove() * 7] & _bitboards[PieceType::QUEEN]; }
+    FORCE_INLINE uint64_t getCurrentPlayerKingMask() const { return _bitboards[whiteToMove() * 7] & _bitboards[PieceType::KING]; }
 
     FORCE_INLINE uint64_t getOtherPlayerPiecesMask() const { return _bitboards[blackToMove() * 7]; }
-    FORCE_INLINE uint64_t getOtherPlayerPawnsMask() const { return _bitboards[blackToMove() * 7 + PieceType::PAWN]; }
-    FORCE_INLINE uint64_t getOtherPlayerKnightsMask() const { return _bitboards[blackToMove() * 7 + PieceType::KNIGHT]; }
-    FORCE_INLINE uint64_t getOtherPlayerBishopsMask() const { return _bitboards[blackToMove() * 7 + PieceType::BISHOP]; }
-    FORCE_INLINE uint64_t getOtherPlayerRooksMask() const { return _bitboards[blackToMove() * 7 + PieceType::ROOK]; }
-    FORCE_INLINE uint64_t getOtherPlayerQueenMask() const { return _bitboards[blackToMove() * 7 + PieceType::QUEEN]; }
-    FORCE_INLINE uint64_t getOtherPlayerKingMask() const { return _bitboards[blackToMove() * 7 + PieceType::KING]; }
+    FORCE_INLINE uint64_t getOtherPlayerPawnsMask() const { return _bitboards[blackToMove() * 7] & _bitboards[PieceType::PAWN]; }
+    FORCE_INLINE uint64_t getOtherPlayerKnightsMask() const { return _bitboards[blackToMove() * 7] & _bitboards[PieceType::KNIGHT]; }
+    FORCE_INLINE uint64_t getOtherPlayerBishopsMask() const { return _bitboards[blackToMove() * 7] & _bitboards[PieceType::BISHOP]; }
+    FORCE_INLINE uint64_t getOtherPlayerRooksMask() const { return _bitboards[blackToMove() * 7] & _bitboards[PieceType::ROOK]; }
+    FORCE_INLINE uint64_t getOtherPlayerQueenMask() const { return _bitboards[blackToMove() * 7] & _bitboards[PieceType::QUEEN]; }
+    FORCE_INLINE uint64_t getOtherPlayerKingMask() const { return _bitboards[blackToMove() * 7] & _bitboards[PieceType::KING]; }
+
+    FORCE_INLINE uint64_t getPlayerPiecesMask(Player player) const { return _bitboards[IS_WHITE(player) * 7]; }
+    FORCE_INLINE uint64_t getPiecesMask(PieceType piece) const { return _bitboards[IS_WHITE(piece) * 7] & _bitboards[PIECE_TYPE(piece)]; }
 
-    FORCE_INLINE uint64_t getOccupiedMask() const { return _bitboards[14]; }
-    FORCE_INLINE uint64_t getNotOccupiedMask() const { return _bitboards[15]; }
+    template<Player player> FORCE_INLINE uint64_t getPlayerPiecesMask() const { return _bitboards[IS_WHITE(player) * 7]; }
+    template<Player player> FORCE_INLINE uint64_t getPiecesMask(PieceType pieceType) const { return _bitboards[IS_WHITE(player) * 7] & _bitboards[pieceType]; }
 
-    FORCE_INLINE PieceType getPieceBySq0x88(uint8_t sq0x88) const { return _0x88[sq0x88]; }
-    FORCE_INLINE PieceType getPieceBySq8x8(uint8_t sq8x8) const { return _0x88[sq0x88BySq8x8(sq8x8)]; }
-    FORCE_INLINE PieceType getPieceByMask8x8(uint64_t mask8x8) const { return _0x88[sq0x88ByMask8x8(mask8x8)]; }
+    FORCE_INLINE uint64_t getOccupiedMask() const { return _bitboards[0] | _bitboards[7]; }
+    FORCE_INLINE uint64_t getNotOccupiedMask() const { return ~(_bitboards[0] | _bitboards[7]); }
+
+    FORCE_INLINE PieceType getPieceBySq0x88(uint8_t sq0x88) const { return _mailbox[sq8x8BySq0x88(sq0x88)]; }
+    FORCE_INLINE PieceType getPieceBySq8x8(uint8_t sq8x8) const { return _mailbox[sq8x8]; }
+    FORCE_INLINE PieceType getPieceByMask8x8(uint64_t mask8x8) const { return _mailbox[sq8x8ByMask8x8(mask8x8)]; }
 
     FORCE_INLINE Player playerToMove() const { return _player; }
     FORCE_INLINE Player playerNotToMove() const { return GET_OTHER_PLAYER(_player); }
     FORCE_INLINE bool whiteToMove() const { return IS_WHITE(_player); }
     FORCE_INLINE bool blackToMove() const { return IS_BLACK(_player); }
 
-    FORCE_INLINE uint64_t getMoveNumber() const { return _moveNumber; }
-
+    FORCE_INLINE uint32_t getMoveNumber() const { return _moveNumber; }
+    FORCE_INLINE uint8_t getEnPassantSq8x8() const { return _enPassantSq8x8; }
+    FORCE_INLINE uint8_t getHalfmoveClock() const { return _halfmoveClock; }
     FORCE_INLINE uint64_t getHash() const { return _hash; }
 
 
     /**
-     * Applies given move to the current board state.
+     * Applies given move of the given player to the current board state.
+     * Pieces are taken from the board so the move has to belong to the current board state.
+     */
+    template<Player player, bool verifyAfterwards = false>
+    FORCE_INLINE void applyMoveBy(Move move) {
+
+        PROFILE_SCOPE(APPLY_MOVE);
+
+        constexpr Player otherPlayer = GET_OTHER_PLAYER(player);
+        constexpr uint8_t playerOffset = IS_WHITE(player) * 7;
+        constexpr uint8_t otherPlayerOffset = IS_WHITE(otherPlayer) * 7;
+
+        uint8_t fromSq8x8 = move.getFromSq8x8();
+        uint8_t toSq8x8 = move.getToSq8x8();
+        uint64_t fromMask8x8 = mask8x8BySq8x8(fromSq8x8);
+        uint64_t toMask8x8 = mask8x8BySq8x8(toSq8x8);
+        PieceType movingPiece = _mailbox[fromSq8x8];
+        PieceType capturedPiece = _mailbox[toSq8x8];
+        PieceType movingPieceType = PIECE_TYPE(movingPiece);
+        PieceType capturedPieceType = PIECE_TYPE(capturedPiece);
+
+        _mailbox[toSq8x8] = movingPiece;
+        _mailbox[fromSq8x8] = PieceType::NONE;
+
+        // the type of an empty field is 0, clearing the empty target field from the black pieces is harmless
+        _bitboards[otherPlayerOffset] &= ~toMask8x8;
+        _bitboards[capturedPieceType] &= ~toMask8x8;
+
+        _bitboards[playerOffset] ^= fromMask8x8 | toMask8x8;
+        _bitboards[movingPieceType] ^= fromMask8x8 | toMask8x8;
+
+        _player = otherPlayer;
+
+        ++_moveNumber;
+
+        _enPassantSq8x8 = noEnPassantSq8x8;
+        _halfmoveClock = (IS_PAWN(movingPiece) || !IS_EMPTY(capturedPiece)) ? 0 : _halfmoveClock + (_halfmoveClock < 255);
+
+        _hash ^= _hashTable[fromSq8x8][getPieceIndex(movingPiece)];
+        _hash ^= _hashTable[toSq8x8][getPieceIndex(movingPiece)];
+        _hash ^= _hashTable[toSq8x8][getPieceIndex(capturedPiece)];
+        _hash ^= _blackToMoveHash;
+
+
+        if(verifyAfterwards) verify();
+    }
+
+
+    /**
+     * Applies given move of the player to move to the current board state.
      */
     template<bool verifyAfterwards = false>
     FORCE_INLINE void applyMove(Move move) {
 
-        uint64_t fromMask8x8 = mask8x8BySq0x88(move.fromSq0x88);
-        uint64_t toMask8x8 = mask8x8BySq0x88(move.toSq0x88);
-        PieceType movingPieceType = PIECE_TYPE(move.movingPieceType);
-        PieceType capturedPieceType = PIECE_TYPE(move.capturedPieceType);
-        Player movingPlayer = GET_PLAYER(move.movingPieceType);
-        Player otherPlayer = GET_OTHER_PLAYER(movingPlayer);
+        if(whiteToMove()) {
+
+            applyMoveBy<Player::WHITE, verifyAfterwards>(move);
+        }
+        else {
+
+            applyMoveBy<Player::BLACK, verifyAfterwards>(move);
+        }
+    }
 
-        _0x88[move.toSq0x88] = move.movingPieceType;
-        _0x88[move.fromSq0x88] = PieceType::NONE;
 
-        _bitboards[IS_WHITE(movingPlayer) * 7] ^= fromMask8x8;
-        _bitboards[IS_WHITE(movingPlayer) * 7] |= toMask8x8;
-        _bitboards[IS_WHITE(movingPlayer) * 7 + movingPieceType] ^= fromMask8x8;
-        _bitboards[IS_WHITE(movingPlayer) * 7 + movingPieceType] |= toMask8x8;
+    /**
+     * Applies given move of the given player and records everything needed to take it back in the given undo record.
+     */
+    template<Player player, bool verifyAfterwards = false>
+    FORCE_INLINE void makeMoveBy(Move move, Undo &undo) {
 
-        _bitboards[IS_WHITE(otherPlayer) * 7] &= ~toMask8x8;
-        _bitboards[IS_WHITE(otherPlayer) * 7 + capturedPieceType] &= ~toMask8x8;
+        undo.capturedPieceType = _mailbox[move.getToSq8x8()];
+        undo.bitfield = _bitfield;
+        undo.enPassantSq8x8 = _enPassantSq8x8;
+        undo.halfmoveClock = _halfmoveClock;
+        undo.hash = _hash;
 
-        _bitboards[14] ^= fromMask8x8;
-        _bitboards[14] |= toMask8x8;
-        _bitboards[15] ^= fromMask8x8;
-        _bitboards[15] &= ~toMask8x8;
+        applyMoveBy<player, verifyAfterwards>(move);
+    }
 
-        _player = GET_OTHER_PLAYER(_player);
 
-        ++_moveNumber;
+    template<bool verifyAfterwards = false>
+    FORCE_INLINE void makeMove(Move move, Undo &undo) {
+
+        if(whiteToMove()) {
+
+            makeMoveBy<Player::WHITE, verifyAfterwards>(move, undo);
+        }
+        else {
 
-        // todo: replace with (cheaper) update function
-        computeHash();
+            makeMoveBy<Player::BLACK, verifyAfterwards>(move, undo);
+        }
+    }
+
+
+    /**
+     * Takes back given move of the given player that has been applied with makeMove().
+     */
+    template<Player player, bool verifyAfterwards = false>
+    FORCE_INLINE void unmakeMoveBy(Move move, const Undo &undo) {
+
+        PROFILE_SCOPE(UNMAKE_MOVE);
+
+        constexpr uint8_t playerOffset = IS_WHITE(player) * 7;
+        constexpr uint8_t otherPlayerOffset = IS_BLACK(player) * 7;
+
+        uint8_t fromSq8x8 = move.getFromSq8x8();
+        uint8_t toSq8x8 = move.getToSq8x8();
+        uint64_t fromMask8x8 = mask8x8BySq8x8(fromSq8x8);
+        uint64_t toMask8x8 = mask8x8BySq8x8(toSq8x8);
+        uint64_t capturedMask8x8 = toMask8x8 * !IS_EMPTY(undo.capturedPieceType);
+        PieceType movingPiece = _mailbox[toSq8x8];
+        PieceType movingPieceType = PIECE_TYPE(movingPiece);
+        PieceType capturedPieceType = PIECE_TYPE(undo.capturedPieceType);
+
+        _mailbox[fromSq8x8] = movingPiece;
+        _mailbox[toSq8x8] = undo.capturedPieceType;
+
+        _bitboards[playerOffset] ^= fromMask8x8 | toMask8x8;
+        _bitboards[movingPieceType] ^= fromMask8x8 | toMask8x8;
+
+        _bitboards[otherPlayerOffset] |= capturedMask8x8;
+        _bitboards[capturedPieceType] |= capturedMask8x8;
+
+        _player = player;
+
+        --_moveNumber;
+
+        _bitfield = undo.bitfield;
+        _enPassantSq8x8 = undo.enPassantSq8x8;
+        _halfmoveClock = undo.halfmoveClock;
+        _hash = undo.hash;
 
 
         if(verifyAfterwards) verify();
     }
 
 
+    /**
+     * Takes back given move that has been applied with makeMove() by the player not to move.
+     */
+    template<bool verifyAfterwards = false>
+    FORCE_INLINE void unmakeMove(Move move, const Undo &undo) {
+
+        if(blackToMove()) {
+
+            unmakeMoveBy<Player::WHITE, verifyAfterwards>(move, undo);
+        }
+        else {
+
+            unmakeMoveBy<Player::BLACK, verifyAfterwards>(move, undo);
+        }
+    }
+
+
+    /**
+     * Passes the turn to the other player without moving a piece (null move).
+     * Only the player to move and the hash change so the same call takes the null move back.
+     */
+    FORCE_INLINE void makeNullMove() {
+
+        _player = GET_OTHER_PLAYER(_player);
+
+        _hash ^= _blackToMoveHash;
+    }
+
+
+    FORCE_INLINE void unmakeNullMove() {
+
+        makeNullMove();
+    }
+
+
     /**
      * Reset the board to the default position.
      */
     void reset() {
 
-        _bitboards[7]                       = 0b0000000000000000000000000000000000000000000000001111111111111111;
-        _bitboards[7 + PieceType::PAWN]     = 0b0000000000000000000000000000000000000000000000001111111100000000;
-        _bitboards[7 + PieceType::ROOK]     = 0b0000000000000000000000000000000000000000000000000000000010000001;
-        _bitboards[7 + PieceType::KNIGHT]   = 0b0000000000000000000000000000000000000000000000000000000001000010;
-        _bitboards[7 + PieceType::BISHOP]   = 0b0000000000000000000000000000000000000000000000000000000000100100;
-        _bitboards[7 + PieceType::QUEEN]    = 0b0000000000000000000000000000000000000000000000000000000000001000;
-        _bitboards[7 + PieceType::KING]     = 0b0000000000000000000000000000000000000000000000000000000000010000;
-
-        _bitboards[0]                       = 0b1111111111111111000000000000000000000000000000000000000000000000;
-        _bitboards[0 + PieceType::PAWN]     = 0b0000000011111111000000000000000000000000000000000000000000000000;
-        _bitboards[0 + PieceType::ROOK]     = 0b1000000100000000000000000000000000000000000000000000000000000000;
-        _bitboards[0 + PieceType::KNIGHT]   = 0b0100001000000000000000000000000000000000000000000000000000000000;
-        _bitboards[0 + PieceType::BISHOP]   = 0b0010010000000000000000000000000000000000000000000000000000000000;
-        _bitboards[0 + PieceType::QUEEN]    = 0b0000100000000000000000000000000000000000000000000000000000000000;
-        _bitboards[0 + PieceType::KING]     = 0b0001000000000000000000000000000000000000000000000000000000000000;
-
-        _bitboards[14]                      = 0b1111111111111111000000000000000000000000000000001111111111111111;
-        _bitboards[15]                      = 0b0000000000000000111111111111111111111111111111110000000000000000;
-
-        _0x88 = {
+        _bitboards[7]                   = 0b0000000000000000000000000000000000000000000000001111111111111111;
+        _bitboards[0]                   = 0b1111111111111111000000000000000000000000000000000000000000000000;
+
+        _bitboards[PieceType::PAWN]     = 0b0000000011111111000000000000000000000000000000001111111100000000;
+        _bitboards[PieceType::ROOK]     = 0b1000000100000000000000000000000000000000000000000000000010000001;
+        _bitboards[PieceType::KNIGHT]   = 0b0100001000000000000000000000000000000000000000000000000001000010;
+        _bitboards[PieceType::BISHOP]   = 0b0010010000000000000000000000000000000000000000000000000000100100;
+        _bitboards[PieceType::QUEEN]    = 0b0000100000000000000000000000000000000000000000000000000000001000;
+        _bitboards[PieceType::KING]     = 0b0001000000000000000000000000000000000000000000000000000000010000;
+
+        _mailbox = {
             PieceType::WHITE_ROOK, PieceType::WHITE_KNIGHT, PieceType::WHITE_BISHOP, PieceType::WHITE_QUEEN, PieceType::WHITE_KING, PieceType::WHITE_BISHOP, PieceType::WHITE_KNIGHT, PieceType::WHITE_ROOK,
-            PieceType::INVALID, PieceType::INVALID, PieceType::INVALID, PieceType::INVALID, PieceType::INVALID, PieceType::INVALID, PieceType::INVALID, PieceType::INVALID,
             PieceType::WHITE_PAWN, PieceType::WHITE_PAWN, PieceType::WHITE_PAWN, PieceType::WHITE_PAWN, PieceType::WHITE_PAWN, PieceType::WHITE_PAWN, PieceType::WHITE_PAWN, PieceType::WHITE_PAWN,
-            PieceType::INVALID, PieceType::INVALID, PieceType::INVALID, PieceType::INVALID, PieceType::INVALID, PieceType::INVALID, PieceType::INVALID, PieceType::INVALID,
             PieceType::NONE, PieceType::NONE, PieceType::NONE, PieceType::NONE, PieceType::NONE, PieceType::NONE, PieceType::NONE, PieceType::NONE,
-            PieceType::INVALID, PieceType::INVALID, PieceType::INVALID, PieceType::INVALID, PieceType::INVALID, PieceType::INVALID, PieceType::INVALID, PieceType::INVALID,
             PieceType::NONE, PieceType::NONE, PieceType::NONE, PieceType::NONE, PieceType::NONE, PieceType::NONE, PieceType::NONE, PieceType::NONE,
-            PieceType::INVALID, PieceType::INVALID, PieceType::INVALID, PieceType::INVALID, PieceType::INVALID, PieceType::INVALID, PieceType::INVALID, PieceType::INVALID,
             PieceType::NONE, PieceType::NONE, PieceType::NONE, PieceType::NONE, PieceType::NONE, PieceType::NONE, PieceType::NONE, PieceType::NONE,
-            PieceType::INVALID, PieceType::INVALID, PieceType::INVALID, PieceType::INVALID, PieceType::INVALID, PieceType::INVALID, PieceType::INVALID, PieceType::INVALID,
             PieceType::NONE, PieceType::NONE, PieceType::NONE, PieceType::NONE, PieceType::NONE, PieceType::NONE, PieceType::NONE, PieceType::NONE,
-            PieceType::INVALID, PieceType::INVALID, PieceType::INVALID, PieceType::INVALID, PieceType::INVALID, PieceType::INVALID, PieceType::INVALID, PieceType::INVALID,
             PieceType::BLACK_PAWN, PieceType::BLACK_PAWN, PieceType::BLACK_PAWN, PieceType::BLACK_PAWN, PieceType::BLACK_PAWN, PieceType::BLACK_PAWN, PieceType::BLACK_PAWN, PieceType::BLACK_PAWN,
-            PieceType::INVALID, PieceType::INVALID, PieceType::INVALID, PieceType::INVALID, PieceType::INVALID, PieceType::INVALID, PieceType::INVALID, PieceType::INVALID,
-            PieceType::BLACK_ROOK, PieceType::BLACK_KNIGHT, PieceType::BLACK_BISHOP, PieceType::BLACK_QUEEN, PieceType::BLACK_KING, PieceType::BLACK_BISHOP, PieceType::BLACK_KNIGHT, PieceType::BLACK_ROOK,
-            PieceType::INVALID, PieceType::INVALID, PieceType::INVALID, PieceType::INVALID, PieceType::INVALID, PieceType::INVALID, PieceType::INVALID, PieceType::INVALID
+            PieceType::BLACK_ROOK, PieceType::BLACK_KNIGHT, PieceType::BLACK_BISHOP, PieceType::BLACK_QUEEN, PieceType::BLACK_KING, PieceType::BLACK_BISHOP, PieceType::BLACK_KNIGHT, PieceType::BLACK_ROOK
         };
 
         _player = Player::WHITE;
 
         _moveNumber = 1;
 
-        // todo: init bitfield
+        // todo: castling flags
+        _bitfield = 0;
+
+        _enPassantSq8x8 = noEnPassantSq8x8;
+        _halfmoveClock = 0;
 
-        computeHash();
+        _hash = computeFullHash();
     }
 
 
+    /**
+     * Sets up the position of the given FEN string ("<pieces> <player to move> [castling] [en passant] [halfmove clock] [fullmove number]").
+     * Castling rights are ignored as the engine does not support them yet.
+     *
+     * @return Whether the FEN string was valid. The board is left in an unspecified state otherwise.
+     */
+    bool setFen(const std::string &fen);
+
+
     bool isFinalState() const {
 
         // todo: check for cheque-mate
 
-        return false;
+        // moves are pseudo-legal so the game ends with the capture of a king
+        return !getWhiteKingMask() || !getBlackKingMask();
     }
 
 
     /**
-     * Can be used to check for consistency between 0x88 and bitboard representations.
+     * Can be used to check for consistency between mailbox and bitboard representations and of the incrementally updated hash.
      */
     FORCE_INLINE void verify() const {
 
         #define __CHECK(Y, X) if(!(X)) { std::cerr << algebraicByMask8x8(Y) << ": !(" << #X << ")" << std::endl; std::exit(1); }
 
-        for(uint8_t sq0x88 = 0; sq0x88 < 120; ++sq0x88) {
-
-            if(!sq0x88Valid(sq0x88)) continue;
+        for(uint8_t sq8x8 = 0; sq8x8 < 64; ++sq8x8) {
 
-            uint64_t mask8x8 = mask8x8BySq0x88(sq0x88);
+            uint64_t mask8x8 = mask8x8BySq8x8(sq8x8);
 
-            PieceType piece = _0x88[sq0x88];
+            PieceType piece = _mailbox[sq8x8];
             PieceType pieceType = PIECE_TYPE(piece);
             Player player = GET_PLAYER(piece);
 
             __CHECK(mask8x8, IS_EMPTY(piece) != HAS_SET_BITS_64(mask8x8 & _bitboards[IS_WHITE(player) * 7]));
-            __CHECK(mask8x8, IS_EMPTY(piece) != HAS_SET_BITS_64(mask8x8 & _bitboards[IS_WHITE(player) * 7 + pieceType]));
-            __CHECK(mask8x8, IS_EMPTY(piece) != HAS_SET_BITS_64(mask8x8 & _bitboards[14]));
-            __CHECK(mask8x8, IS_EMPTY(piece) == HAS_SET_BITS_64(mask8x8 & _bitboards[15]));
+            __CHECK(mask8x8, IS_EMPTY(piece) != HAS_SET_BITS_64(mask8x8 & _bitboards[pieceType]));
+            __CHECK(mask8x8, IS_EMPTY(piece) != HAS_SET_BITS_64(mask8x8 & getOccupiedMask()));
+            __CHECK(mask8x8, !HAS_SET_BITS_64(mask8x8 & _bitboards[0] & _bitboards[7]));
+
+            for(uint8_t otherPieceType = PieceType::PAWN; otherPieceType <= PieceType::KING; ++otherPieceType) {
+
+                __CHECK(mask8x8, otherPieceType == pieceType || !HAS_SET_BITS_64(mask8x8 & _bitboards[otherPieceType]));
+            }
+        }
+
+        if(_hash != computeFullHash()) {
+
+            std::cerr << "hash: !(_hash == computeFullHash())" << std::endl;
+            std::exit(1);
         }
     }
 
@@ -302,3 +464,7 @@ public:
         return out;
     }
 };
+
+static_assert(sizeof(Board) == 192, "Boards are expected to fill exactly three cache lines");
+static_assert(sizeof(Board::Undo) == 16, "Undo records are expected to be packed into 16 bytes");
+static_assert(std::is_trivially_copyable<Board>::value, "Boards are expected to be trivially copyable");
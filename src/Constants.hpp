@@ -72,6 +72,16 @@ enum Player : uint8_t {
 const uint8_t playerMask = 0b00011000;
 
 
+/**
+ * Schemes to distribute a search over several threads.
+ */
+enum ParallelSearch : uint8_t {
+
+    LAZY_SMP,   // independent searches of the root position sharing the transposition table
+    YBWC        // young brothers wait: siblings are searched in parallel once the first child is done
+};
+
+
 /**
  * Some macros to extract basic information about a given piece.
  */
@@ -134,15 +144,47 @@ enum DirectionDelta0x88 : uint8_t {
 #define HOT __attribute__ ((hot))
 
 
+/**
+ * Parallel bit extract: gathers the bits of value selected by mask into the low bits of the result.
+ * On x86-64 this is the BMI2 instruction (same as _pext_u64()) emitted as inline assembly so that it gets inlined
+ * into code compiled without -mbmi2. Callers have to check for CPU support first (see MoveGenerator::initialize()).
+ */
+FORCE_INLINE uint64_t pext64(uint64_t value, uint64_t mask) {
+
+#if defined(__x86_64__)
+
+    uint64_t result;
+
+    __asm__("pextq %2, %1, %0" : "=r" (result) : "r" (value), "r" (mask));
+
+    return result;
+
+#else
+
+    uint64_t result = 0;
+
+    for(uint64_t bit = 1; mask; bit <<= 1) {
+
+        if(value & mask & -mask) result |= bit;
+
+        mask &= mask - 1;
+    }
+
+    return result;
+
+#endif
+}
+
+
 /**
  * Returns an index for every piece type.
  * 0:       PieceType::NONE
- * 1-7:     PieceType::WHITE
- * 8-14:    PieceType::BLACK
+ * 1-6:     PieceType::WHITE_*
+ * 7-12:    PieceType::BLACK_*
  */
 FORCE_INLINE uint8_t getPieceIndex(PieceType piece) {
 
-    return (piece & pieceTypeMask) + (0b00000110 >> ((!HAS_SET_BITS_8(piece & Player::BLACK)) << 8));
+    return (piece & pieceTypeMask) + 6 * IS_BLACK(piece);
 }
 
 
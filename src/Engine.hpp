@@ -18,183 +18,902 @@
 
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <limits>
-#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 #include "Board.hpp"
 #include "Constants.hpp"
 #include "Evaluation.hpp"
 #include "Move.hpp"
-#include "SortedMoveGenerator.hpp"
+#include "MovePicker.hpp"
+#include "SearchLimits.hpp"
+#include "SearchStack.hpp"
+#include "SearchStats.hpp"
+#include "TranspositionTable.hpp"
+#include "WorkStealingPool.hpp"
 
 
-template<bool useLookupTable = true>
+/**
+ * Iterative deepening negamax search bounded by the given search limits.
+ *
+ * With more than one thread the search runs either as Lazy SMP or as young brothers wait (YBWC).
+ *
+ * Lazy SMP: helper engines search the same root position on their own threads and only share the transposition
+ * table. Every other helper searches one ply deeper than the main engine so that they fill the table ahead of it.
+ * The main engine alone decides on the best move and stops all helpers when it is done.
+ *
+ * YBWC: the first move of a node is searched alone, then the remaining moves become tasks of a work-stealing pool
+ * whose workers search them on the helper engines. A beta cutoff found by one of them aborts its siblings.
+ *
+ * useLookupTable - remember values and best moves of already searched positions in the transposition table
+ * copyMake - search child positions on copies of the current board instead of applying and taking back moves
+ */
+template<bool useLookupTable = true, bool copyMake = false>
 class Engine {
 
 protected:
 
+    // nodes searched between two checks of the search limits
+    static const uint64_t pollInterval = 1024;
+
+    static const int64_t infinity = std::numeric_limits<int64_t>::max();
+
+    // initial half width of aspiration windows and the width from which on the full window is searched instead
+    static const int64_t aspirationDelta = 1;
+    static const int64_t maxAspirationDelta = 64;
+
+    // null moves and late move reductions are only tried with at least this remaining depth
+    static const uint8_t minNullMoveDepth = 3;
+    static const uint8_t minReductionDepth = 3;
+
+    // quiet moves are reduced once this many moves have been searched before them at the same node
+    static const uint8_t minReducedMoveCount = 3;
+
+    // smaller subtrees are not worth the overhead of being searched in parallel
+    static const uint8_t minSplitDepth = 4;
+
+
+    /**
+     * Node whose remaining moves are searched in parallel (YBWC).
+     * Tasks only read the board and window and publish their results under the mutex.
+     */
+    struct SplitPoint {
+
+        // enclosing split point of the splitting engine, its cutoff aborts this one as well
+        const SplitPoint *parent;
+
+        Board board;
+        uint8_t depth;
+        uint8_t ply;
+        int64_t beta;
+        bool inCheck;
+
+        std::mutex mutex;
+        std::atomic<int64_t> bestValue;
+        Move bestMove;
+        bool hasBestMove = false;
+        std::array<Move, maxPly> principalVariation;
+        uint8_t principalVariationLength = 0;
+        std::atomic<bool> cutoff;
+
+        TaskGroup taskGroup;
+
+        SplitPoint(const SplitPoint *parent, const Board &board, uint8_t depth, uint8_t ply, int64_t alpha, int64_t beta, bool inCheck) :
+            parent(parent), board(board), depth(depth), ply(ply), beta(beta), inCheck(inCheck), bestValue(alpha), cutoff(false) {}
+    };
+
     Evaluation _evaluation;
 
-    Board &_initialBoard;
-    uint8_t _initialDepth;
+    // each thread searches its own copy of the root position
+    Board _initialBoard;
+    SearchLimits _limits;
+
+    TranspositionTable &_transpositionTable;
+
+    // move lists, undo records (unused with copyMake) and principal variations indexed by ply
+    SearchStack _searchStack;
 
-    Move _bestMove;
+    // best move and principal variation of the last completed iteration
+    // the best move stays Move(uint16_t(0)) if the player to move has no move
+    Move _bestMove = Move(uint16_t(0));
+    std::array<Move, maxPly> _principalVariation;
+    uint8_t _principalVariationLength = 0;
 
-    std::map<uint64_t, int64_t> _knownPositions;
+    // butterfly history of quiet moves causing beta cutoffs (see MovePicker)
+    MovePicker::THistoryTable _history;
+
+    // set while descending along the principal variation of the last completed iteration
+    bool _followPrincipalVariation = false;
+
+    // score of the last completed iteration from the perspective of the player to move
+    int64_t _score = 0;
+
+    uint8_t _completedDepth = 0;
+
+    // counters of this thread, merged by getSearchStats()
+    SearchStats _stats;
+
+    // written by the searching thread only but read by the main engine while searching
+    std::atomic<uint64_t> _nodeCount;
+
+    // 0 for the main engine
+    uint8_t _threadIndex;
+    Engine *_mainEngine;
+    std::vector<std::unique_ptr<Engine>> _helpers;
+
+    ParallelSearch _parallelSearch;
+
+    // workers of the main engine running YBWC tasks on the helpers, declared after them to stop first
+    std::unique_ptr<WorkStealingPool> _pool;
+
+    // innermost split point whose task this engine is currently searching
+    const SplitPoint *_splitPoint = nullptr;
+
+    std::chrono::steady_clock::time_point _startTime;
+    std::atomic<bool> _stopRequested;
+    bool _stopped = false;
 
 
     /**
-     * Initial call to finding
+     * Searches with increasing depth until the depth limit is reached or the search is stopped.
+     * Results of an interrupted iteration are discarded.
+     *
+     * Iterations after the first start with an aspiration window around the score of the previous one
+     * which is widened on fail-highs and fail-lows until the score falls inside.
      */
     FORCE_INLINE void findBestMove() {
 
-        if(_initialBoard.whiteToMove()) {
+        _startTime = std::chrono::steady_clock::now();
+        _completedDepth = 0;
+        _principalVariationLength = 0;
+
+        resetSearchState();
+
+        for(uint8_t iteration = 1; iteration <= _limits.depth; iteration++) {
+
+            uint64_t iterationStartNodeCount = getNodeCount();
+            uint8_t depth = std::min(uint8_t(iteration + (_threadIndex & 1)), _limits.depth);
+            int64_t delta = aspirationDelta;
+            int64_t score;
+
+            while(true) {
+
+                bool aspiration = depth > 1 && delta < maxAspirationDelta;
+                int64_t alpha = aspiration ? _score - delta : -infinity;
+                int64_t beta = aspiration ? _score + delta : infinity;
+
+                _followPrincipalVariation = true;
+
+                score = search(_initialBoard, depth, 0, alpha, beta);
+
+                if(_stopped || (score > alpha && score < beta)) break;
+
+                delta *= 4;
+            }
+
+            if(_stopped) break;
+
+            SearchStackEntry &rootEntry = _searchStack[0];
 
-            max(_initialBoard, _initialDepth, std::numeric_limits<int64_t>::min(), std::numeric_limits<int64_t>::max());
+            if(rootEntry.principalVariationLength) {
+
+                _principalVariation = rootEntry.principalVariation;
+                _principalVariationLength = rootEntry.principalVariationLength;
+                _bestMove = _principalVariation[0];
+            }
+
+            _score = score;
+            _completedDepth = depth;
+
+            _stats.iterationNodes[depth] = getNodeCount() - iterationStartNodeCount;
+            _stats.completedDepth = depth;
+        }
+    }
+
+
+    /**
+     * Clears node count, stop flag and move ordering statistics before a new search.
+     */
+    void resetSearchState() {
+
+        _nodeCount = 0;
+        _stopped = false;
+        _stats = SearchStats();
+
+        for(auto &playerHistory : _history) {
+
+            for(auto &fromHistory : playerHistory) {
+
+                fromHistory.fill(0);
+            }
         }
-        else {
 
-            min(_initialBoard, _initialDepth, std::numeric_limits<int64_t>::min(), std::numeric_limits<int64_t>::max());
+        for(uint8_t ply = 0; ply <= maxPly; ply++) {
+
+            _searchStack[ply].killers.fill(Move(uint16_t(0)));
         }
     }
 
 
+    FORCE_INLINE uint64_t getElapsedMilliseconds() const {
+
+        return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - _startTime).count();
+    }
+
+
     /**
-     * Alpha-Beta-Pruning
+     * Counts the current node and checks the search limits every pollInterval nodes.
+     * Limits of the main engine only apply after its first iteration so that there always is a best move.
+     * Helpers have no limits of their own and only wait for the main engine to stop them.
      */
-    HOT int64_t max(Board &currentBoard, uint8_t depth, int64_t alpha, int64_t beta) {
+    FORCE_INLINE bool shouldStop() {
 
-        SortedMoveGenerator moveGenerator;
-        Board nextBoard;
-        auto maxValue = alpha;
+        uint64_t nodeCount = _nodeCount.load(std::memory_order_relaxed) + 1;
+
+        _nodeCount.store(nodeCount, std::memory_order_relaxed);
 
-        if(depth == 0 || moveGenerator.generateMoves(currentBoard) == 0) {
+        if((nodeCount % pollInterval) == 0) {
 
-            return _evaluation.evaluate(currentBoard);
+            checkLimits();
         }
 
-        while(!moveGenerator.empty()) {
+        return isAborted();
+    }
 
-            new (&nextBoard) Board(currentBoard);
-            nextBoard.applyMove(*moveGenerator);
 
+    /**
+     * Stops the search if one of the limits has been reached. The main engine stops its helpers right away.
+     */
+    void checkLimits() {
 
-            int64_t minValue;
+        if(_stopped || (_completedDepth == 0 && _threadIndex == 0)) return;
 
-            if(useLookupTable) {
+        _stopped = _stopRequested.load(std::memory_order_relaxed)
+            || (_limits.nodes && getNodeCount() >= _limits.nodes)
+            || (_limits.moveTime && getElapsedMilliseconds() >= _limits.moveTime);
 
-                auto hash = nextBoard.getHash() ^ static_cast<uint64_t>(depth);
-                auto it = _knownPositions.find(hash);
+        if(_stopped) {
 
-                if(it == _knownPositions.end()) {
+            for(auto &helper : _helpers) {
 
-                    minValue = min(nextBoard, depth - 1, maxValue, beta);
+                helper->stop();
+            }
+        }
+    }
 
-                    _knownPositions[hash] = minValue;
-                }
-                else {
 
-                    minValue = it->second;
-                }
+    /**
+     * Whether the search has been stopped or a sibling has refuted one of the split points being searched.
+     */
+    FORCE_INLINE bool isAborted() const {
+
+        for(const SplitPoint *splitPoint = _splitPoint; splitPoint; splitPoint = splitPoint->parent) {
+
+            if(splitPoint->cutoff.load(std::memory_order_relaxed)) return true;
+        }
+
+        return _stopped;
+    }
+
+
+    /**
+     * @return The engine searching YBWC tasks on the given worker of the pool.
+     */
+    Engine &getWorkerEngine(size_t workerIndex) {
+
+        return workerIndex ? *_helpers[workerIndex - 1] : *this;
+    }
+
+
+    /**
+     * Prepends the given move to the principal variation of the next ply.
+     */
+    FORCE_INLINE void updatePrincipalVariation(uint8_t ply, const Move &move) {
+
+        SearchStackEntry &stackEntry = _searchStack[ply];
+        SearchStackEntry &childStackEntry = _searchStack[ply + 1];
+
+        stackEntry.principalVariation[0] = move;
+
+        std::copy(childStackEntry.principalVariation.begin(), std::next(childStackEntry.principalVariation.begin(), childStackEntry.principalVariationLength), std::next(stackEntry.principalVariation.begin()));
+
+        stackEntry.principalVariationLength = childStackEntry.principalVariationLength + 1;
+    }
+
+
+    /**
+     * Returns the evaluation from the perspective of the given player to move.
+     */
+    template<Player player>
+    FORCE_INLINE int64_t evaluate(Board &board) {
+
+        return _evaluation.evaluate<player>(board);
+    }
+
+
+    /**
+     * Searches captures only until the position is quiet to avoid evaluating in the middle of an exchange.
+     * The player to move may always stand pat on the static evaluation instead of capturing.
+     * Captures losing material according to the static exchange evaluation are skipped.
+     */
+    template<Player player>
+    HOT int64_t quiescence(Board &currentBoard, uint8_t ply, int64_t alpha, int64_t beta) {
+
+        constexpr Player otherPlayer = GET_OTHER_PLAYER(player);
+
+        SearchStackEntry &stackEntry = _searchStack[ply];
+        MovePicker moveGenerator(stackEntry.moves, stackEntry.scores);
+        Board nextBoard;
+
+        _followPrincipalVariation = false;
+        stackEntry.principalVariationLength = 0;
+
+        if(shouldStop()) return 0;
+
+        _stats.quiescenceNodes++;
+
+        int64_t standPat = evaluate<player>(currentBoard);
+
+        if(standPat >= beta || ply >= maxPly) return standPat;
+
+        auto bestValue = std::max(alpha, standPat);
+
+        moveGenerator.initCaptures(currentBoard);
+
+        while(!moveGenerator.empty()) {
+
+            if(_evaluation.staticExchange(currentBoard, *moveGenerator) < 0) {
+
+                ++moveGenerator;
+                continue;
             }
 
+            Board &childBoard = copyMake ? nextBoard : currentBoard;
+
+            if(copyMake) {
+
+                new (&nextBoard) Board(currentBoard);
+                nextBoard.applyMoveBy<player>(*moveGenerator);
+            }
             else {
 
-                minValue = min(nextBoard, depth - 1, maxValue, beta);
+                currentBoard.makeMoveBy<player>(*moveGenerator, stackEntry.undo);
             }
 
+            int64_t value = -quiescence<otherPlayer>(childBoard, ply + 1, -beta, -bestValue);
 
-            if(minValue > maxValue) {
+            if(!copyMake) {
 
-                maxValue = minValue;
+                currentBoard.unmakeMoveBy<player>(*moveGenerator, stackEntry.undo);
+            }
 
-                // beta cutoff
-                if(maxValue >= beta) break;
+            if(isAborted()) return 0;
 
-                if(depth == _initialDepth) {
 
-                    new (&_bestMove) Move(*moveGenerator);
-                }
+            if(value > bestValue) {
+
+                bestValue = value;
+
+                // beta cutoff
+                if(bestValue >= beta) break;
             }
 
             ++moveGenerator;
         }
 
-        return maxValue;
+        return bestValue;
     }
 
 
-    HOT int64_t min(Board &currentBoard, uint8_t depth, int64_t alpha, int64_t beta) {
+    /**
+     * Negamax alpha-beta search with principal variation search.
+     * Values are given from the perspective of the player to move, which has to be the given player.
+     * The player is a template argument so that each node recurses into the specialization of the other player.
+     */
+    template<Player player>
+    HOT int64_t search(Board &currentBoard, uint8_t depth, uint8_t ply, int64_t alpha, int64_t beta) {
+
+        constexpr Player otherPlayer = GET_OTHER_PLAYER(player);
 
-        SortedMoveGenerator moveGenerator;
+        SearchStackEntry &stackEntry = _searchStack[ply];
+        MovePicker moveGenerator(stackEntry.moves, stackEntry.scores);
         Board nextBoard;
-        auto minValue = beta;
+        auto bestValue = alpha;
+
+        Move bestMove;
+        bool hasBestMove = false;
+
+        bool followPrincipalVariation = _followPrincipalVariation && ply < _principalVariationLength;
+        _followPrincipalVariation = false;
+
+        stackEntry.principalVariationLength = 0;
+
+        if(depth == 0) {
+
+            return quiescence<player>(currentBoard, ply, alpha, beta);
+        }
+
+        if(shouldStop()) return 0;
+
+        TranspositionTableData entry;
+        bool entryFound = useLookupTable && _transpositionTable.probe(currentBoard.getHash(), entry);
+
+        _stats.transpositionTableProbes += useLookupTable;
+        _stats.transpositionTableHits += entryFound;
+
+        if(entryFound && entry.getDepth() >= depth && ply != 0) {
+
+            if((entry.getBound() == Bound::EXACT)
+                || (entry.getBound() == Bound::LOWER_BOUND && entry.getValue() >= beta)
+                || (entry.getBound() == Bound::UPPER_BOUND && entry.getValue() <= alpha)) {
+
+                _stats.transpositionTableCutoffs++;
+
+                return entry.getValue();
+            }
+        }
+
+        bool inCheck = MoveGenerator::isInCheck<player>(currentBoard);
+
+        stackEntry.nullMove = false;
+
+        // null move pruning: if passing the turn still fails high the position is good enough to skip searching it
+        // not done in check (the king would be captured), in zugzwang-prone positions with only king and pawns left,
+        // twice in a row or in principal variation nodes
+        if(depth >= minNullMoveDepth && ply != 0 && beta - alpha == 1 && !inCheck && !_searchStack[ply - 1].nullMove
+            && (currentBoard.getPlayerPiecesMask<player>() & ~(currentBoard.getPiecesMask<player>(PieceType::PAWN) | currentBoard.getPiecesMask<player>(PieceType::KING)))
+            && evaluate<player>(currentBoard) >= beta) {
+
+            uint8_t reduction = (depth >= 7) ? 3 : 2;
+            Board &childBoard = copyMake ? nextBoard : currentBoard;
+
+            if(copyMake) {
+
+                new (&nextBoard) Board(currentBoard);
+            }
+
+            stackEntry.nullMove = true;
+            childBoard.makeNullMove();
+
+            int64_t value = -search<otherPlayer>(childBoard, depth - 1 - std::min(reduction, uint8_t(depth - 1)), ply + 1, -beta, -beta + 1);
+
+            childBoard.unmakeNullMove();
+            stackEntry.nullMove = false;
+
+            if(isAborted()) return 0;
+
+            if(value >= beta) return beta;
+        }
+
+        // search best move of the previous iteration or of former searches first
+        Move hashMove(uint16_t(0));
+
+        if(followPrincipalVariation) {
+
+            hashMove = _principalVariation[ply];
+        }
+        else if(entryFound && entry.hasMove()) {
 
-        if(depth == 0 || moveGenerator.generateMoves(currentBoard) == 0) {
+            hashMove = entry.getMove();
+        }
+
+        moveGenerator.init(currentBoard, hashMove, stackEntry.killers, _history);
+
+        if(moveGenerator.empty()) {
 
-            return _evaluation.evaluate(currentBoard);
+            _stats.countGeneratedMoves(0);
+
+            return evaluate<player>(currentBoard);
         }
 
+        uint8_t moveCount = 0;
+
         while(!moveGenerator.empty()) {
 
-            new (&nextBoard) Board(currentBoard);
-            nextBoard.applyMove(*moveGenerator);
+            // young brothers wait: the remaining moves are searched in parallel once the first one is done
+            if(moveCount && depth >= minSplitDepth && _mainEngine->_pool) {
+
+                split(currentBoard, moveGenerator, depth, ply, beta, inCheck, moveCount, bestValue, bestMove, hasBestMove);
+
+                if(isAborted()) return 0;
+
+                _stats.betaCutoffs += bestValue >= beta;
+
+                if(bestValue >= beta && IS_EMPTY(currentBoard.getPieceBySq8x8(bestMove.getToSq8x8()))) {
+
+                    MovePicker::updateKillers(stackEntry.killers, bestMove);
+                    MovePicker::updateHistory(_history, currentBoard, bestMove, depth);
+                }
+
+                break;
+            }
+
+            Board &childBoard = copyMake ? nextBoard : currentBoard;
+
+            if(copyMake) {
+
+                new (&nextBoard) Board(currentBoard);
+                nextBoard.applyMoveBy<player>(*moveGenerator);
+            }
+            else {
+
+                currentBoard.makeMoveBy<player>(*moveGenerator, stackEntry.undo);
+            }
 
+            int64_t value;
 
-            int64_t maxValue;
+            if(moveCount == 0) {
 
-            if(useLookupTable) {
+                _followPrincipalVariation = followPrincipalVariation && *moveGenerator == _principalVariation[ply];
 
-                auto hash = nextBoard.getHash() ^ static_cast<uint64_t>(depth);
-                auto it = _knownPositions.find(hash);
+                value = -search<otherPlayer>(childBoard, depth - 1, ply + 1, -beta, -bestValue);
+            }
+            else {
 
-                if(it == _knownPositions.end()) {
+                // late move reductions: quiet moves ordered late are searched less deep first
+                // not done in check or for moves giving check
+                uint8_t reduction = 0;
 
-                    maxValue = max(nextBoard, depth - 1, alpha, minValue);
+                if(depth >= minReductionDepth && moveCount >= minReducedMoveCount && !inCheck && moveGenerator.getStage() == PickerStage::PICK_QUIETS && !MoveGenerator::isInCheck<otherPlayer>(childBoard)) {
 
-                    _knownPositions[hash] = maxValue;
+                    reduction = (depth >= 6 && moveCount >= 2 * minReducedMoveCount) ? 2 : 1;
                 }
-                else {
 
-                    maxValue = it->second;
+                // prove that later moves are worse with a null window and only search them fully otherwise
+                value = -search<otherPlayer>(childBoard, depth - 1 - reduction, ply + 1, -bestValue - 1, -bestValue);
+
+                if(reduction && value > bestValue && !isAborted()) {
+
+                    value = -search<otherPlayer>(childBoard, depth - 1, ply + 1, -bestValue - 1, -bestValue);
+                }
+
+                if(value > bestValue && value < beta && !isAborted()) {
+
+                    value = -search<otherPlayer>(childBoard, depth - 1, ply + 1, -beta, -bestValue);
                 }
             }
 
-            else {
+            moveCount += moveCount < 255;
+
+            if(!copyMake) {
 
-                maxValue = max(nextBoard, depth - 1, alpha, minValue);
+                currentBoard.unmakeMoveBy<player>(*moveGenerator, stackEntry.undo);
             }
 
+            if(isAborted()) return 0;
 
-            if(maxValue < minValue) {
 
-                minValue = maxValue;
+            if(value > bestValue) {
+
+                bestValue = value;
+
+                new (&bestMove) Move(*moveGenerator);
+                hasBestMove = true;
+
+                // beta cutoff
+                if(bestValue >= beta) {
+
+                    _stats.betaCutoffs++;
+                    _stats.firstMoveCutoffs += moveCount == 1;
 
-                // alpha cutoff
-                if(minValue <= alpha) break;
+                    if(IS_EMPTY(currentBoard.getPieceBySq8x8((*moveGenerator).getToSq8x8()))) {
 
-                if(depth == _initialDepth) {
+                        MovePicker::updateKillers(stackEntry.killers, *moveGenerator);
+                        MovePicker::updateHistory(_history, currentBoard, *moveGenerator, depth);
+                    }
 
-                    new (&_bestMove) Move(*moveGenerator);
+                    break;
                 }
+
+                updatePrincipalVariation(ply, *moveGenerator);
             }
 
             ++moveGenerator;
         }
 
-        return minValue;
+        _stats.countGeneratedMoves(moveGenerator.getTotalMoveCount());
+
+        if(useLookupTable) {
+
+            Bound bound = (bestValue >= beta) ? Bound::LOWER_BOUND : ((bestValue > alpha) ? Bound::EXACT : Bound::UPPER_BOUND);
+
+            _transpositionTable.store(currentBoard.getHash(), bestValue, bestMove, hasBestMove, depth, bound);
+        }
+
+        return bestValue;
+    }
+
+
+    /**
+     * Dispatches to the search specialized for the player to move of the given board.
+     */
+    int64_t search(Board &currentBoard, uint8_t depth, uint8_t ply, int64_t alpha, int64_t beta) {
+
+        return currentBoard.whiteToMove() ? search<Player::WHITE>(currentBoard, depth, ply, alpha, beta) : search<Player::BLACK>(currentBoard, depth, ply, alpha, beta);
+    }
+
+
+    /**
+     * Searches the remaining moves of the given node as tasks of the pool and waits for them.
+     * The splitting engine keeps running tasks of this node itself while waiting.
+     * Improvements of the best value and principal variation are passed back like from the serial move loop.
+     */
+    void split(const Board &currentBoard, MovePicker &moveGenerator, uint8_t depth, uint8_t ply, int64_t beta, bool inCheck, uint8_t moveCount,
+        int64_t &bestValue, Move &bestMove, bool &hasBestMove) {
+
+        WorkStealingPool &pool = *_mainEngine->_pool;
+        SplitPoint splitPoint(_splitPoint, currentBoard, depth, ply, bestValue, beta, inCheck);
+        Engine *mainEngine = _mainEngine;
+
+        for(; !moveGenerator.empty(); ++moveGenerator) {
+
+            Move move = *moveGenerator;
+            bool quiet = moveGenerator.getStage() == PickerStage::PICK_QUIETS;
+
+            pool.submit(splitPoint.taskGroup, _threadIndex, [mainEngine, &splitPoint, move, moveCount, quiet](size_t workerIndex) {
+
+                mainEngine->getWorkerEngine(workerIndex).searchSplitMove(splitPoint, move, moveCount, quiet);
+            });
+
+            moveCount += moveCount < 255;
+        }
+
+        while(splitPoint.taskGroup.pendingTasks.load() > 0) {
+
+            if(!pool.runTask(splitPoint.taskGroup, _threadIndex)) {
+
+                // the main engine keeps an eye on the limits while its helpers are busy
+                if(_threadIndex == 0) checkLimits();
+
+                std::this_thread::yield();
+            }
+        }
+
+        if(splitPoint.bestValue > bestValue) {
+
+            bestValue = splitPoint.bestValue;
+            bestMove = splitPoint.bestMove;
+            hasBestMove = true;
+
+            if(bestValue < beta) {
+
+                SearchStackEntry &stackEntry = _searchStack[ply];
+
+                stackEntry.principalVariation = splitPoint.principalVariation;
+                stackEntry.principalVariationLength = splitPoint.principalVariationLength;
+            }
+        }
+    }
+
+
+    /**
+     * Task of a split point: searches one of its moves with the same reductions and windows as the serial move loop.
+     */
+    void searchSplitMove(SplitPoint &splitPoint, const Move &move, uint8_t moveCount, bool quiet) {
+
+        const SplitPoint *enclosingSplitPoint = _splitPoint;
+        _splitPoint = &splitPoint;
+
+        int64_t alpha = splitPoint.bestValue;
+        uint8_t depth = splitPoint.depth;
+        uint8_t ply = splitPoint.ply;
+
+        if(!isAborted() && alpha < splitPoint.beta) {
+
+            Board childBoard(splitPoint.board);
+            childBoard.applyMove(move);
+
+            _searchStack[ply].nullMove = false;
+            _followPrincipalVariation = false;
+
+            uint8_t reduction = 0;
+
+            if(depth >= minReductionDepth && moveCount >= minReducedMoveCount && !splitPoint.inCheck && quiet && !MoveGenerator::isInCheck(childBoard)) {
+
+                reduction = (depth >= 6 && moveCount >= 2 * minReducedMoveCount) ? 2 : 1;
+            }
+
+            int64_t value = -search(childBoard, depth - 1 - reduction, ply + 1, -alpha - 1, -alpha);
+
+            if(reduction && value > alpha && !isAborted()) {
+
+                value = -search(childBoard, depth - 1, ply + 1, -alpha - 1, -alpha);
+            }
+
+            if(value > alpha && value < splitPoint.beta && !isAborted()) {
+
+                value = -search(childBoard, depth - 1, ply + 1, -splitPoint.beta, -alpha);
+            }
+
+            if(!isAborted()) {
+
+                std::lock_guard<std::mutex> lock(splitPoint.mutex);
+
+                if(value > splitPoint.bestValue && !splitPoint.cutoff) {
+
+                    SearchStackEntry &childStackEntry = _searchStack[ply + 1];
+
+                    splitPoint.bestValue = value;
+                    splitPoint.bestMove = move;
+                    splitPoint.hasBestMove = true;
+
+                    splitPoint.principalVariation[0] = move;
+                    std::copy(childStackEntry.principalVariation.begin(), std::next(childStackEntry.principalVariation.begin(), childStackEntry.principalVariationLength), std::next(splitPoint.principalVariation.begin()));
+                    splitPoint.principalVariationLength = childStackEntry.principalVariationLength + 1;
+
+                    // beta cutoff, the remaining siblings are no longer needed
+                    if(value >= splitPoint.beta) {
+
+                        splitPoint.cutoff = true;
+                    }
+                }
+            }
+        }
+
+        _splitPoint = enclosingSplitPoint;
+    }
+
+
+    /**
+     * Creates a helper of the given main engine searching without limits apart from the depth.
+     */
+    Engine(Engine &mainEngine, uint8_t threadIndex) :
+        _initialBoard(mainEngine._initialBoard), _transpositionTable(mainEngine._transpositionTable), _nodeCount(0), _threadIndex(threadIndex),
+        _mainEngine(&mainEngine), _parallelSearch(mainEngine._parallelSearch), _stopRequested(false) {
+
+        _limits.depth = mainEngine._limits.depth;
     }
 
 
 public:
 
-    Engine(Board &initialBoard, uint8_t initialDepth) : _initialBoard(initialBoard), _initialDepth(initialDepth) {}
+    /**
+     * threads - number of threads to search with (main engine included)
+     * parallelSearch - how the threads share the search
+     */
+    Engine(const Board &initialBoard, const SearchLimits &limits, TranspositionTable &transpositionTable, uint8_t threads = 1,
+        ParallelSearch parallelSearch = ParallelSearch::LAZY_SMP) :
+        _initialBoard(initialBoard), _limits(limits), _transpositionTable(transpositionTable), _nodeCount(0), _threadIndex(0),
+        _mainEngine(this), _parallelSearch(parallelSearch), _stopRequested(false) {
+
+        _limits.depth = std::min(std::max(_limits.depth, uint8_t(1)), maxPly);
+
+        for(uint8_t threadIndex = 1; threadIndex < threads; threadIndex++) {
 
+            _helpers.emplace_back(new Engine(*this, threadIndex));
+        }
+
+        if(_parallelSearch == ParallelSearch::YBWC && threads > 1) {
 
+            _pool.reset(new WorkStealingPool(threads));
+        }
+    }
+
+
+    /**
+     * Runs the search and returns the best move of the last completed iteration.
+     * Returns Move(uint16_t(0)) (a move that is never generated) if the player to move has no move.
+     */
     Move &getBestMove() {
 
+        std::vector<std::thread> threads;
+        std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+        _transpositionTable.newSearch();
+
+        for(auto &helper : _helpers) {
+
+            Engine *engine = helper.get();
+
+            engine->_stopRequested.store(false, std::memory_order_relaxed);
+
+            if(_parallelSearch == ParallelSearch::LAZY_SMP) {
+
+                threads.emplace_back([engine]() { engine->findBestMove(); });
+            }
+            else {
+
+                // YBWC helpers are driven by the pool and keep their state between tasks of the same search
+                engine->resetSearchState();
+            }
+        }
+
         findBestMove();
 
+        for(auto &helper : _helpers) {
+
+            helper->stop();
+        }
+
+        for(auto &thread : threads) {
+
+            thread.join();
+        }
+
+        _stats.microseconds = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count();
+
         return _bestMove;
     }
-};
\ No newline at end of file
+
+
+    /**
+     * Makes a running search return as soon as possible. Safe to call from other threads.
+     */
+    void stop() {
+
+        _stopRequested.store(true, std::memory_order_relaxed);
+    }
+
+
+    uint8_t getCompletedDepth() const {
+
+        return _completedDepth;
+    }
+
+
+    int64_t getScore() const {
+
+        return _score;
+    }
+
+
+    /**
+     * @return Nodes searched by all threads.
+     */
+    uint64_t getNodeCount() const {
+
+        uint64_t nodeCount = _nodeCount.load(std::memory_order_relaxed);
+
+        for(auto &helper : _helpers) {
+
+            nodeCount += helper->_nodeCount.load(std::memory_order_relaxed);
+        }
+
+        return nodeCount;
+    }
+
+
+    /**
+     * @return Counters of the last search merged over all threads.
+     */
+    SearchStats getSearchStats() const {
+
+        SearchStats stats = _stats;
+
+        stats.nodes = _nodeCount.load(std::memory_order_relaxed);
+
+        for(auto &helper : _helpers) {
+
+            SearchStats helperStats = helper->_stats;
+
+            helperStats.nodes = helper->_nodeCount.load(std::memory_order_relaxed);
+
+            stats.merge(helperStats);
+        }
+
+        return stats;
+    }
+
+
+    /**
+     * @return Nodes searched by each thread starting with the main engine.
+     */
+    std::vector<uint64_t> getThreadNodeCounts() const {
+
+        std::vector<uint64_t> nodeCounts(1, _nodeCount.load(std::memory_order_relaxed));
+
+        for(auto &helper : _helpers) {
+
+            nodeCounts.push_back(helper->_nodeCount.load(std::memory_order_relaxed));
+        }
+
+        return nodeCounts;
+    }
+};
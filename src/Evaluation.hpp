@@ -18,31 +18,133 @@
 
 #pragma once
 
+#include <algorithm>
+#include <array>
 #include <cstdlib>
 
 #include "Board.hpp"
 #include "Constants.hpp"
+#include "Move.hpp"
+#include "MoveGenerator.hpp"
+#include "Profiler.hpp"
+
+
+/**
+ * Material values indexed by impersonal piece type (PieceType::NONE maps to 0).
+ */
+constexpr int64_t pieceValues[8] = {0, 1, 4, 3, 5, 9, 1000, 0};
+
+/**
+ * Impersonal piece types by ascending material value, the order in which an exchange uses up the attackers.
+ */
+constexpr PieceType piecesByValue[6] = {PieceType::PAWN, PieceType::BISHOP, PieceType::KNIGHT, PieceType::ROOK, PieceType::QUEEN, PieceType::KING};
+
+static_assert(pieceValues[PieceType::PAWN] <= pieceValues[PieceType::BISHOP] && pieceValues[PieceType::BISHOP] <= pieceValues[PieceType::KNIGHT]
+    && pieceValues[PieceType::KNIGHT] <= pieceValues[PieceType::ROOK] && pieceValues[PieceType::ROOK] <= pieceValues[PieceType::QUEEN]
+    && pieceValues[PieceType::QUEEN] <= pieceValues[PieceType::KING], "piecesByValue must follow the piece values");
 
 
 class Evaluation {
 
 public:
 
+    static FORCE_INLINE int64_t getPieceValue(PieceType piece) {
+
+        return pieceValues[PIECE_TYPE(piece)];
+    }
+
+
     /**
      * Evaluates a given board state.
      * Positive values indicate a benefit for white, negative for black.
      */
     FORCE_INLINE int64_t evaluate(Board &board) {
 
+        PROFILE_SCOPE(EVALUATE);
+
         int64_t ret = 0;
 
-        ret += 1000 * (SET_BITS_64(board.getWhiteKingMask()) - SET_BITS_64(board.getBlackKingMask()));
-        ret += 9 * (SET_BITS_64(board.getWhiteQueenMask()) - SET_BITS_64(board.getBlackQueenMask()));
-        ret += 5 * (SET_BITS_64(board.getWhiteRooksMask()) - SET_BITS_64(board.getBlackRooksMask()));
-        ret += 4 * (SET_BITS_64(board.getWhiteKnightsMask()) - SET_BITS_64(board.getBlackKnightsMask()));
-        ret += 3 * (SET_BITS_64(board.getWhiteBishopsMask()) - SET_BITS_64(board.getBlackBishopsMask()));
-        ret += 1 * (SET_BITS_64(board.getWhitePawnsMask()) - SET_BITS_64(board.getBlackPawnsMask()));
+        ret += pieceValues[PieceType::KING] * (SET_BITS_64(board.getWhiteKingMask()) - SET_BITS_64(board.getBlackKingMask()));
+        ret += pieceValues[PieceType::QUEEN] * (SET_BITS_64(board.getWhiteQueenMask()) - SET_BITS_64(board.getBlackQueenMask()));
+        ret += pieceValues[PieceType::ROOK] * (SET_BITS_64(board.getWhiteRooksMask()) - SET_BITS_64(board.getBlackRooksMask()));
+        ret += pieceValues[PieceType::KNIGHT] * (SET_BITS_64(board.getWhiteKnightsMask()) - SET_BITS_64(board.getBlackKnightsMask()));
+        ret += pieceValues[PieceType::BISHOP] * (SET_BITS_64(board.getWhiteBishopsMask()) - SET_BITS_64(board.getBlackBishopsMask()));
+        ret += pieceValues[PieceType::PAWN] * (SET_BITS_64(board.getWhitePawnsMask()) - SET_BITS_64(board.getBlackPawnsMask()));
 
         return ret;
     }
-};
\ No newline at end of file
+
+
+    /**
+     * Evaluates a given board state from the perspective of the given player.
+     */
+    template<Player player>
+    FORCE_INLINE int64_t evaluate(Board &board) {
+
+        return IS_WHITE(player) ? evaluate(board) : -evaluate(board);
+    }
+
+
+    /**
+     * Static exchange evaluation of the given capture (or quiet move) on the current board state.
+     * Both players alternately recapture on the target field with their least valuable attacker until one of them
+     * stops because recapturing would lose material. Sliders behind moved pieces (x-rays) join in.
+     *
+     * @return Material gained by the moving player.
+     */
+    FORCE_INLINE int64_t staticExchange(const Board &board, const Move &move) {
+
+        uint8_t toSq8x8 = move.getToSq8x8();
+        uint64_t fromMask8x8 = mask8x8BySq8x8(move.getFromSq8x8());
+        uint64_t occupiedMask8x8 = board.getOccupiedMask();
+        uint64_t diagonalSlidersMask8x8 = board.getWhiteBishopsMask() | board.getBlackBishopsMask() | board.getWhiteQueenMask() | board.getBlackQueenMask();
+        uint64_t straightSlidersMask8x8 = board.getWhiteRooksMask() | board.getBlackRooksMask() | board.getWhiteQueenMask() | board.getBlackQueenMask();
+        uint64_t attackersMask8x8 = MoveGenerator::getAttackersMask(board, toSq8x8, occupiedMask8x8);
+
+        PieceType attacker = board.getPieceBySq8x8(move.getFromSq8x8());
+        Player player = GET_PLAYER(attacker);
+
+        // gains[i] - material balance after the i-th capture from the perspective of the player making it
+        std::array<int64_t, 32> gains;
+        uint8_t depth = 0;
+
+        gains[0] = getPieceValue(board.getPieceBySq8x8(toSq8x8));
+
+        do {
+
+            depth++;
+
+            // speculative balance if the piece just moved onto the target field gets captured
+            gains[depth] = getPieceValue(attacker) - gains[depth - 1];
+
+            occupiedMask8x8 ^= fromMask8x8;
+
+            // reveal sliders behind the piece that just moved
+            attackersMask8x8 |= (MoveGenerator::getBishopAttacks(toSq8x8, occupiedMask8x8) & diagonalSlidersMask8x8) | (MoveGenerator::getRookAttacks(toSq8x8, occupiedMask8x8) & straightSlidersMask8x8);
+            attackersMask8x8 &= occupiedMask8x8;
+
+            player = GET_OTHER_PLAYER(player);
+            fromMask8x8 = 0;
+
+            // least valuable attacker of the player to recapture
+            for(PieceType pieceType : piecesByValue) {
+
+                attacker = static_cast<PieceType>(player | pieceType);
+                fromMask8x8 = attackersMask8x8 & board.getPiecesMask(attacker);
+
+                if(fromMask8x8) break;
+            }
+
+            fromMask8x8 &= -fromMask8x8;
+        }
+        while(fromMask8x8 && depth < gains.size() - 1);
+
+        // each player may stop capturing when continuing would lose material
+        while(--depth) {
+
+            gains[depth - 1] = -std::max(-gains[depth - 1], gains[depth]);
+        }
+
+        return gains[0];
+    }
+};
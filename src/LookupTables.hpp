@@ -0,0 +1,279 @@
+/**
+ * Redfish is an open-source chess engine.
+ * Copyright (C) 2016 Arne Groskurth
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "Constants.hpp"
+
+
+/**
+ * Compile-time index list used to expand table rows from constexpr functions.
+ */
+template<size_t... indices>
+struct IndexSequence {};
+
+template<size_t count, size_t... indices>
+struct MakeIndexSequence : MakeIndexSequence<count - 1, count - 1, indices...> {};
+
+template<size_t... indices>
+struct MakeIndexSequence<0, indices...> {
+
+    typedef IndexSequence<indices...> type;
+};
+
+
+/**
+ * Generators of the constant lookup tables of Board and MoveGenerator.
+ * Everything is constexpr so that the tables are emitted as initialized data instead of being computed at startup
+ * and are identical on every run. Restricted to C++11 constexpr: single return statements and recursion.
+ */
+class LookupTables {
+
+protected:
+
+    typedef std::array<uint64_t, 13> TZobristRow;
+    typedef std::array<uint64_t, 256> TPieceRow;
+    typedef std::array<uint64_t, 64> TSquareRow;
+
+
+    static constexpr uint64_t mix(uint64_t z) {
+
+        return z ^ (z >> 31);
+    }
+
+    static constexpr uint64_t mix2(uint64_t z) {
+
+        return mix((z ^ (z >> 27)) * 0x94d049bb133111ebull);
+    }
+
+    static constexpr uint64_t mix1(uint64_t z) {
+
+        return mix2((z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull);
+    }
+
+    /**
+     * n-th output of the splitmix64 generator seeded with 0.
+     */
+    static constexpr uint64_t splitMix64(uint64_t n) {
+
+        return mix1((n + 1) * 0x9e3779b97f4a7c15ull);
+    }
+
+
+    static constexpr uint64_t maskByRowAndColumn(int row, int column) {
+
+        return (row >= 0 && row < 8 && column >= 0 && column < 8) ? uint64_t(1) << (row * 8 + column) : 0;
+    }
+
+    /**
+     * Fields from the given one (exclusive) in the given direction up to the border of the board.
+     */
+    static constexpr uint64_t rayMask(int row, int column, int rowDelta, int columnDelta) {
+
+        return maskByRowAndColumn(row + rowDelta, column + columnDelta)
+            ? maskByRowAndColumn(row + rowDelta, column + columnDelta) | rayMask(row + rowDelta, column + columnDelta, rowDelta, columnDelta)
+            : 0;
+    }
+
+    /**
+     * Fields from the given one (exclusive) in the given direction up to the target field (exclusive).
+     */
+    static constexpr uint64_t betweenMask(int row, int column, int toRow, int toColumn, int rowDelta, int columnDelta) {
+
+        return (row + rowDelta == toRow && column + columnDelta == toColumn)
+            ? 0
+            : maskByRowAndColumn(row + rowDelta, column + columnDelta) | betweenMask(row + rowDelta, column + columnDelta, toRow, toColumn, rowDelta, columnDelta);
+    }
+
+    static constexpr int sign(int value) {
+
+        return (value > 0) - (value < 0);
+    }
+
+    static constexpr int absolute(int value) {
+
+        return value < 0 ? -value : value;
+    }
+
+
+    static constexpr uint64_t knightTargets(int row, int column) {
+
+        return maskByRowAndColumn(row - 2, column - 1) | maskByRowAndColumn(row - 2, column + 1)
+            | maskByRowAndColumn(row - 1, column - 2) | maskByRowAndColumn(row - 1, column + 2)
+            | maskByRowAndColumn(row + 1, column - 2) | maskByRowAndColumn(row + 1, column + 2)
+            | maskByRowAndColumn(row + 2, column - 1) | maskByRowAndColumn(row + 2, column + 1);
+    }
+
+    static constexpr uint64_t kingTargets(int row, int column) {
+
+        return maskByRowAndColumn(row - 1, column - 1) | maskByRowAndColumn(row - 1, column) | maskByRowAndColumn(row - 1, column + 1)
+            | maskByRowAndColumn(row, column - 1) | maskByRowAndColumn(row, column + 1)
+            | maskByRowAndColumn(row + 1, column - 1) | maskByRowAndColumn(row + 1, column) | maskByRowAndColumn(row + 1, column + 1);
+    }
+
+    static constexpr uint64_t bishopTargets(int row, int column) {
+
+        return rayMask(row, column, 1, 1) | rayMask(row, column, 1, -1) | rayMask(row, column, -1, 1) | rayMask(row, column, -1, -1);
+    }
+
+    static constexpr uint64_t rookTargets(int row, int column) {
+
+        return rayMask(row, column, 1, 0) | rayMask(row, column, -1, 0) | rayMask(row, column, 0, 1) | rayMask(row, column, 0, -1);
+    }
+
+    /**
+     * Single and double pushes (the latter from the start row only) and both captures.
+     */
+    static constexpr uint64_t pawnTargets(int row, int column, int direction, int startRow) {
+
+        return (row == startRow ? maskByRowAndColumn(row + 2 * direction, column) : 0)
+            | maskByRowAndColumn(row + direction, column - 1) | maskByRowAndColumn(row + direction, column) | maskByRowAndColumn(row + direction, column + 1);
+    }
+
+    static constexpr uint64_t pawnOpponentRequired(int row, int column, int direction) {
+
+        return maskByRowAndColumn(row + direction, column - 1) | maskByRowAndColumn(row + direction, column + 1)
+            | maskByRowAndColumn(row, column - 1) | maskByRowAndColumn(row, column + 1);
+    }
+
+
+    static constexpr uint64_t jumpTableEntry(int sq8x8, int piece) {
+
+        return piece == PieceType::WHITE_PAWN ? pawnTargets(sq8x8 / 8, sq8x8 % 8, 1, 1)
+            : piece == PieceType::BLACK_PAWN ? pawnTargets(sq8x8 / 8, sq8x8 % 8, -1, 6)
+            : (piece == PieceType::WHITE_KNIGHT || piece == PieceType::BLACK_KNIGHT) ? knightTargets(sq8x8 / 8, sq8x8 % 8)
+            : (piece == PieceType::WHITE_BISHOP || piece == PieceType::BLACK_BISHOP) ? bishopTargets(sq8x8 / 8, sq8x8 % 8)
+            : (piece == PieceType::WHITE_ROOK || piece == PieceType::BLACK_ROOK) ? rookTargets(sq8x8 / 8, sq8x8 % 8)
+            : (piece == PieceType::WHITE_QUEEN || piece == PieceType::BLACK_QUEEN) ? bishopTargets(sq8x8 / 8, sq8x8 % 8) | rookTargets(sq8x8 / 8, sq8x8 % 8)
+            : (piece == PieceType::WHITE_KING || piece == PieceType::BLACK_KING) ? kingTargets(sq8x8 / 8, sq8x8 % 8)
+            : 0;
+    }
+
+    static constexpr uint64_t opponentRequiredMaskTableEntry(int sq8x8, int piece) {
+
+        return piece == PieceType::WHITE_PAWN ? pawnOpponentRequired(sq8x8 / 8, sq8x8 % 8, 1)
+            : piece == PieceType::BLACK_PAWN ? pawnOpponentRequired(sq8x8 / 8, sq8x8 % 8, -1)
+            : 0;
+    }
+
+    /**
+     * Fields between two fields on a common row, column or diagonal, zero for other pairs.
+     */
+    static constexpr uint64_t emptyMaskTableEntry(int fromSq8x8, int toSq8x8) {
+
+        return (fromSq8x8 != toSq8x8 && (fromSq8x8 / 8 == toSq8x8 / 8 || fromSq8x8 % 8 == toSq8x8 % 8
+                || absolute(toSq8x8 / 8 - fromSq8x8 / 8) == absolute(toSq8x8 % 8 - fromSq8x8 % 8)))
+            ? betweenMask(fromSq8x8 / 8, fromSq8x8 % 8, toSq8x8 / 8, toSq8x8 % 8, sign(toSq8x8 / 8 - fromSq8x8 / 8), sign(toSq8x8 % 8 - fromSq8x8 % 8))
+            : 0;
+    }
+
+    /**
+     * Fixed Zobrist key of a piece index (see Board::getPieceIndex()) on a field, zero for empty fields.
+     */
+    static constexpr uint64_t zobristKey(int sq8x8, int pieceIndex) {
+
+        return pieceIndex ? splitMix64(sq8x8 * 13 + pieceIndex) : 0;
+    }
+
+
+    template<size_t... pieces>
+    static constexpr TPieceRow jumpTableRow(int sq8x8, IndexSequence<pieces...>) {
+
+        return {{jumpTableEntry(sq8x8, pieces)...}};
+    }
+
+    template<size_t... pieces>
+    static constexpr TPieceRow opponentRequiredMaskTableRow(int sq8x8, IndexSequence<pieces...>) {
+
+        return {{opponentRequiredMaskTableEntry(sq8x8, pieces)...}};
+    }
+
+    template<size_t... toSquares>
+    static constexpr TSquareRow emptyMaskTableRow(int fromSq8x8, IndexSequence<toSquares...>) {
+
+        return {{emptyMaskTableEntry(fromSq8x8, toSquares)...}};
+    }
+
+    template<size_t... pieceIndices>
+    static constexpr TZobristRow zobristRow(int sq8x8, IndexSequence<pieceIndices...>) {
+
+        return {{zobristKey(sq8x8, pieceIndices)...}};
+    }
+
+
+    template<size_t... squares>
+    static constexpr std::array<TPieceRow, 64> jumpTable(IndexSequence<squares...>) {
+
+        return {{jumpTableRow(squares, MakeIndexSequence<256>::type())...}};
+    }
+
+    template<size_t... squares>
+    static constexpr std::array<TPieceRow, 64> opponentRequiredMaskTable(IndexSequence<squares...>) {
+
+        return {{opponentRequiredMaskTableRow(squares, MakeIndexSequence<256>::type())...}};
+    }
+
+    template<size_t... squares>
+    static constexpr std::array<TSquareRow, 64> emptyMaskTable(IndexSequence<squares...>) {
+
+        return {{emptyMaskTableRow(squares, MakeIndexSequence<64>::type())...}};
+    }
+
+    template<size_t... squares>
+    static constexpr std::array<TZobristRow, 64> zobristTable(IndexSequence<squares...>) {
+
+        return {{zobristRow(squares, MakeIndexSequence<13>::type())...}};
+    }
+
+
+public:
+
+    // _jumpTable[fromSq8x8][fromPieceType] - targets on an empty board as mask8x8
+    static constexpr std::array<TPieceRow, 64> jumpTable() {
+
+        return jumpTable(MakeIndexSequence<64>::type());
+    }
+
+    // _opponentRequiredMaskTable[fromSq8x8][fromPieceType] - targets requiring an opponent piece (pawn captures)
+    static constexpr std::array<TPieceRow, 64> opponentRequiredMaskTable() {
+
+        return opponentRequiredMaskTable(MakeIndexSequence<64>::type());
+    }
+
+    // _emptyMaskTable[fromSq8x8][toSq8x8] - fields between both that need to be empty as mask8x8
+    static constexpr std::array<TSquareRow, 64> emptyMaskTable() {
+
+        return emptyMaskTable(MakeIndexSequence<64>::type());
+    }
+
+    // zobristTable[sq8x8][pieceIndex] - fixed random keys per field and piece (zero for PieceType::NONE)
+    static constexpr std::array<TZobristRow, 64> zobristTable() {
+
+        return zobristTable(MakeIndexSequence<64>::type());
+    }
+
+    // key of the player to move, following the piece keys in the same sequence
+    static constexpr uint64_t blackToMoveKey() {
+
+        return splitMix64(64 * 13);
+    }
+};
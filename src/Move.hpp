@@ -19,34 +19,68 @@
 #pragma once
 
 #include <iostream>
+#include <type_traits>
 
 #include "Constants.hpp"
 #include "Misc.hpp"
 #include "PositionMath.hpp"
 
 
+/**
+ * Special move types encoded in bits 12-13 of a move.
+ */
+enum MoveType : uint16_t {
+
+    NORMAL      = 0b00 << 12,
+    PROMOTION   = 0b01 << 12,
+    EN_PASSANT  = 0b10 << 12,
+    CASTLING    = 0b11 << 12
+};
+
+
+/**
+ * Moves are packed into 16 bits:
+ *
+ * bits     description
+ * 0-5      from (sq8x8)
+ * 6-11     to (sq8x8)
+ * 12-13    move type (see MoveType)
+ * 14-15    promotion piece type (PieceType::KNIGHT to PieceType::QUEEN) minus PieceType::KNIGHT
+ *
+ * Moving and captured pieces are not part of the move but taken from the board the move belongs to.
+ * The packed value 0 (a1 to a1) never is a valid move.
+ */
 struct Move {
 
-    PieceType movingPieceType;
-    PieceType capturedPieceType;
+protected:
 
-    uint8_t fromSq0x88;
-    uint8_t toSq0x88;
+    uint16_t _data;
 
 
-    Move() {}
-    FORCE_INLINE Move(const Move &other) {
+public:
 
-        movingPieceType = other.movingPieceType;
-        capturedPieceType = other.capturedPieceType;
-        fromSq0x88 = other.fromSq0x88;
-        toSq0x88 = other.toSq0x88;
-    }
+    Move() = default;
+
+    explicit Move(uint16_t packed) : _data(packed) {}
+
+    Move(uint8_t fromSq8x8, uint8_t toSq8x8, MoveType moveType = MoveType::NORMAL, PieceType promotionPieceType = PieceType::KNIGHT) :
+        _data(fromSq8x8 | (toSq8x8 << 6) | moveType | ((promotionPieceType - PieceType::KNIGHT) << 14)) {}
+
+
+    FORCE_INLINE uint16_t getPacked() const { return _data; }
+
+    FORCE_INLINE uint8_t getFromSq8x8() const { return _data & 0b111111; }
+    FORCE_INLINE uint8_t getToSq8x8() const { return (_data >> 6) & 0b111111; }
+    FORCE_INLINE uint8_t getFromSq0x88() const { return sq0x88BySq8x8(getFromSq8x8()); }
+    FORCE_INLINE uint8_t getToSq0x88() const { return sq0x88BySq8x8(getToSq8x8()); }
+
+    FORCE_INLINE MoveType getMoveType() const { return static_cast<MoveType>(_data & (0b11 << 12)); }
+    FORCE_INLINE PieceType getPromotionPieceType() const { return static_cast<PieceType>((_data >> 14) + PieceType::KNIGHT); }
 
 
     friend bool operator== (const Move &move1, const Move &move2) {
 
-        return move1.fromSq0x88 == move2.fromSq0x88 && move1.toSq0x88 == move2.toSq0x88;
+        return move1._data == move2._data;
     }
 
 
@@ -58,8 +92,16 @@ struct Move {
 
     friend std::ostream& operator<< (std::ostream& out, const Move &move) {
 
-        out << algebraicByMask8x8(mask8x8BySq0x88(move.fromSq0x88)) << ":" << algebraicByMask8x8(mask8x8BySq0x88(move.toSq0x88));
+        out << algebraicByMask8x8(mask8x8BySq8x8(move.getFromSq8x8())) << ":" << algebraicByMask8x8(mask8x8BySq8x8(move.getToSq8x8()));
+
+        if(move.getMoveType() == MoveType::PROMOTION) {
+
+            out << fenCharacters[static_cast<PieceType>(Player::BLACK | move.getPromotionPieceType())];
+        }
 
         return out;
     }
-};
\ No newline at end of file
+};
+
+static_assert(sizeof(Move) == 2, "Moves are expected to be packed into 16 bits");
+static_assert(std::is_trivially_copyable<Move>::value, "Moves are expected to be trivially copyable");
@@ -16,224 +16,246 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
-#include <cstring>
+
+#if defined(__x86_64__)
+#include <cpuid.h>
+#endif
 
 #include "Constants.hpp"
+#include "LookupTables.hpp"
 #include "MoveGenerator.hpp"
 #include "PositionMath.hpp"
 
 
-std::array<std::array<uint64_t, 256>, 64> MoveGenerator::_jumpTable;
-std::array<std::array<uint64_t, 64>, 64> MoveGenerator::_emptyMaskTable;
-std::array<std::array<uint64_t, 256>, 64> MoveGenerator::_opponentRequiredMaskTable;
+// constant expressions, emitted as initialized data
+const std::array<std::array<uint64_t, 256>, 64> MoveGenerator::_jumpTable = LookupTables::jumpTable();
+const std::array<std::array<uint64_t, 64>, 64> MoveGenerator::_emptyMaskTable = LookupTables::emptyMaskTable();
+const std::array<std::array<uint64_t, 256>, 64> MoveGenerator::_opponentRequiredMaskTable = LookupTables::opponentRequiredMaskTable();
 
+std::array<Magic, 64> MoveGenerator::_bishopMagics;
+std::array<Magic, 64> MoveGenerator::_rookMagics;
+std::array<uint64_t, 5248> MoveGenerator::_bishopAttackTable;
+std::array<uint64_t, 102400> MoveGenerator::_rookAttackTable;
+SliderIndexing MoveGenerator::_sliderIndexing = SliderIndexing::MAGIC;
 
-void MoveGenerator::initialize() {
 
-    std::memset(&_jumpTable, 0, sizeof(_jumpTable));
-
-    for(uint8_t fromSq8x8 = 0; fromSq8x8 < 63; fromSq8x8++) {
-
-        uint64_t fromMask8x8 = mask8x8BySq8x8(fromSq8x8);
-        uint8_t row = rowBySq8x8(fromSq8x8);
-
-        if(row == 1) _jumpTable[fromSq8x8][PieceType::WHITE_PAWN] |= addRowsAndColumnsToMask8x8(fromMask8x8, 2, 0);
-        _jumpTable[fromSq8x8][PieceType::WHITE_PAWN] |= addRowsAndColumnsToMask8x8(fromMask8x8, 1, -1);
-        _jumpTable[fromSq8x8][PieceType::WHITE_PAWN] |= addRowsAndColumnsToMask8x8(fromMask8x8, 1, 0);
-        _jumpTable[fromSq8x8][PieceType::WHITE_PAWN] |= addRowsAndColumnsToMask8x8(fromMask8x8, 1, 1);
-        //_jumpTable[fromSq8x8][PieceType::WHITE_PAWN] |= addRowsAndColumnsToMask8x8(fromMask8x8, 0, -1);
-        //_jumpTable[fromSq8x8][PieceType::WHITE_PAWN] |= addRowsAndColumnsToMask8x8(fromMask8x8, 0, 1);
-
-        if(row == 6) _jumpTable[fromSq8x8][PieceType::BLACK_PAWN] |= addRowsAndColumnsToMask8x8(fromMask8x8, -2, 0);
-        _jumpTable[fromSq8x8][PieceType::BLACK_PAWN] |= addRowsAndColumnsToMask8x8(fromMask8x8, -1, -1);
-        _jumpTable[fromSq8x8][PieceType::BLACK_PAWN] |= addRowsAndColumnsToMask8x8(fromMask8x8, -1, 0);
-        _jumpTable[fromSq8x8][PieceType::BLACK_PAWN] |= addRowsAndColumnsToMask8x8(fromMask8x8, -1, 1);
-        //_jumpTable[fromSq8x8][PieceType::BLACK_PAWN] |= addRowsAndColumnsToMask8x8(fromMask8x8, 0, -1);
-        //_jumpTable[fromSq8x8][PieceType::BLACK_PAWN] |= addRowsAndColumnsToMask8x8(fromMask8x8, 0, 1);
-
-        _jumpTable[fromSq8x8][PieceType::WHITE_KNIGHT] |= addRowsAndColumnsToMask8x8(fromMask8x8, -2, -1);
-        _jumpTable[fromSq8x8][PieceType::WHITE_KNIGHT] |= addRowsAndColumnsToMask8x8(fromMask8x8, -2, 1);
-        _jumpTable[fromSq8x8][PieceType::WHITE_KNIGHT] |= addRowsAndColumnsToMask8x8(fromMask8x8, -1, -2);
-        _jumpTable[fromSq8x8][PieceType::WHITE_KNIGHT] |= addRowsAndColumnsToMask8x8(fromMask8x8, -1, 2);
-        _jumpTable[fromSq8x8][PieceType::WHITE_KNIGHT] |= addRowsAndColumnsToMask8x8(fromMask8x8, 1, -2);
-        _jumpTable[fromSq8x8][PieceType::WHITE_KNIGHT] |= addRowsAndColumnsToMask8x8(fromMask8x8, 1, 2);
-        _jumpTable[fromSq8x8][PieceType::WHITE_KNIGHT] |= addRowsAndColumnsToMask8x8(fromMask8x8, 2, -1);
-        _jumpTable[fromSq8x8][PieceType::WHITE_KNIGHT] |= addRowsAndColumnsToMask8x8(fromMask8x8, 2, 1);
-        _jumpTable[fromSq8x8][PieceType::BLACK_KNIGHT] = _jumpTable[fromSq8x8][PieceType::WHITE_KNIGHT];
-
-        _jumpTable[fromSq8x8][PieceType::WHITE_BISHOP] |= addRowsAndColumnsToMask8x8(fromMask8x8, -7, -7);
-        _jumpTable[fromSq8x8][PieceType::WHITE_BISHOP] |= addRowsAndColumnsToMask8x8(fromMask8x8, -6, -6);
-        _jumpTable[fromSq8x8][PieceType::WHITE_BISHOP] |= addRowsAndColumnsToMask8x8(fromMask8x8, -5, -5);
-        _jumpTable[fromSq8x8][PieceType::WHITE_BISHOP] |= addRowsAndColumnsToMask8x8(fromMask8x8, -4, -4);
-        _jumpTable[fromSq8x8][PieceType::WHITE_BISHOP] |= addRowsAndColumnsToMask8x8(fromMask8x8, -3, -3);
-        _jumpTable[fromSq8x8][PieceType::WHITE_BISHOP] |= addRowsAndColumnsToMask8x8(fromMask8x8, -2, -2);
-        _jumpTable[fromSq8x8][PieceType::WHITE_BISHOP] |= addRowsAndColumnsToMask8x8(fromMask8x8, -1, -1);
-        _jumpTable[fromSq8x8][PieceType::WHITE_BISHOP] |= addRowsAndColumnsToMask8x8(fromMask8x8, -7, 7);
-        _jumpTable[fromSq8x8][PieceType::WHITE_BISHOP] |= addRowsAndColumnsToMask8x8(fromMask8x8, -6, 6);
-        _jumpTable[fromSq8x8][PieceType::WHITE_BISHOP] |= addRowsAndColumnsToMask8x8(fromMask8x8, -5, 5);
-        _jumpTable[fromSq8x8][PieceType::WHITE_BISHOP] |= addRowsAndColumnsToMask8x8(fromMask8x8, -4, 4);
-        _jumpTable[fromSq8x8][PieceType::WHITE_BISHOP] |= addRowsAndColumnsToMask8x8(fromMask8x8, -3, 3);
-        _jumpTable[fromSq8x8][PieceType::WHITE_BISHOP] |= addRowsAndColumnsToMask8x8(fromMask8x8, -2, 2);
-        _jumpTable[fromSq8x8][PieceType::WHITE_BISHOP] |= addRowsAndColumnsToMask8x8(fromMask8x8, -1, 1);
-        _jumpTable[fromSq8x8][PieceType::WHITE_BISHOP] |= addRowsAndColumnsToMask8x8(fromMask8x8, 7, -7);
-        _jumpTable[fromSq8x8][PieceType::WHITE_BISHOP] |= addRowsAndColumnsToMask8x8(fromMask8x8, 6, -6);
-        _jumpTable[fromSq8x8][PieceType::WHITE_BISHOP] |= addRowsAndColumnsToMask8x8(fromMask8x8, 5, -5);
-        _jumpTable[fromSq8x8][PieceType::WHITE_BISHOP] |= addRowsAndColumnsToMask8x8(fromMask8x8, 4, -4);
-        _jumpTable[fromSq8x8][PieceType::WHITE_BISHOP] |= addRowsAndColumnsToMask8x8(fromMask8x8, 3, -3);
-        _jumpTable[fromSq8x8][PieceType::WHITE_BISHOP] |= addRowsAndColumnsToMask8x8(fromMask8x8, 2, -2);
-        _jumpTable[fromSq8x8][PieceType::WHITE_BISHOP] |= addRowsAndColumnsToMask8x8(fromMask8x8, 1, -1);
-        _jumpTable[fromSq8x8][PieceType::WHITE_BISHOP] |= addRowsAndColumnsToMask8x8(fromMask8x8, 7, 7);
-        _jumpTable[fromSq8x8][PieceType::WHITE_BISHOP] |= addRowsAndColumnsToMask8x8(fromMask8x8, 6, 6);
-        _jumpTable[fromSq8x8][PieceType::WHITE_BISHOP] |= addRowsAndColumnsToMask8x8(fromMask8x8, 5, 5);
-        _jumpTable[fromSq8x8][PieceType::WHITE_BISHOP] |= addRowsAndColumnsToMask8x8(fromMask8x8, 4, 4);
-        _jumpTable[fromSq8x8][PieceType::WHITE_BISHOP] |= addRowsAndColumnsToMask8x8(fromMask8x8, 3, 3);
-        _jumpTable[fromSq8x8][PieceType::WHITE_BISHOP] |= addRowsAndColumnsToMask8x8(fromMask8x8, 2, 2);
-        _jumpTable[fromSq8x8][PieceType::WHITE_BISHOP] |= addRowsAndColumnsToMask8x8(fromMask8x8, 1, 1);
-        _jumpTable[fromSq8x8][PieceType::BLACK_BISHOP] = _jumpTable[fromSq8x8][PieceType::WHITE_BISHOP];
-
-        _jumpTable[fromSq8x8][PieceType::WHITE_ROOK] |= addRowsAndColumnsToMask8x8(fromMask8x8, -1, 0);
-        _jumpTable[fromSq8x8][PieceType::WHITE_ROOK] |= addRowsAndColumnsToMask8x8(fromMask8x8, -2, 0);
-        _jumpTable[fromSq8x8][PieceType::WHITE_ROOK] |= addRowsAndColumnsToMask8x8(fromMask8x8, -3, 0);
-        _jumpTable[fromSq8x8][PieceType::WHITE_ROOK] |= addRowsAndColumnsToMask8x8(fromMask8x8, -4, 0);
-        _jumpTable[fromSq8x8][PieceType::WHITE_ROOK] |= addRowsAndColumnsToMask8x8(fromMask8x8, -5, 0);
-        _jumpTable[fromSq8x8][PieceType::WHITE_ROOK] |= addRowsAndColumnsToMask8x8(fromMask8x8, -6, 0);
-        _jumpTable[fromSq8x8][PieceType::WHITE_ROOK] |= addRowsAndColumnsToMask8x8(fromMask8x8, -7, 0);
-        _jumpTable[fromSq8x8][PieceType::WHITE_ROOK] |= addRowsAndColumnsToMask8x8(fromMask8x8, 0, -1);
-        _jumpTable[fromSq8x8][PieceType::WHITE_ROOK] |= addRowsAndColumnsToMask8x8(fromMask8x8, 0, -2);
-        _jumpTable[fromSq8x8][PieceType::WHITE_ROOK] |= addRowsAndColumnsToMask8x8(fromMask8x8, 0, -3);
-        _jumpTable[fromSq8x8][PieceType::WHITE_ROOK] |= addRowsAndColumnsToMask8x8(fromMask8x8, 0, -4);
-        _jumpTable[fromSq8x8][PieceType::WHITE_ROOK] |= addRowsAndColumnsToMask8x8(fromMask8x8, 0, -5);
-        _jumpTable[fromSq8x8][PieceType::WHITE_ROOK] |= addRowsAndColumnsToMask8x8(fromMask8x8, 0, -6);
-        _jumpTable[fromSq8x8][PieceType::WHITE_ROOK] |= addRowsAndColumnsToMask8x8(fromMask8x8, 0, -7);
-        _jumpTable[fromSq8x8][PieceType::WHITE_ROOK] |= addRowsAndColumnsToMask8x8(fromMask8x8, 0, 1);
-        _jumpTable[fromSq8x8][PieceType::WHITE_ROOK] |= addRowsAndColumnsToMask8x8(fromMask8x8, 0, 2);
-        _jumpTable[fromSq8x8][PieceType::WHITE_ROOK] |= addRowsAndColumnsToMask8x8(fromMask8x8, 0, 3);
-        _jumpTable[fromSq8x8][PieceType::WHITE_ROOK] |= addRowsAndColumnsToMask8x8(fromMask8x8, 0, 4);
-        _jumpTable[fromSq8x8][PieceType::WHITE_ROOK] |= addRowsAndColumnsToMask8x8(fromMask8x8, 0, 5);
-        _jumpTable[fromSq8x8][PieceType::WHITE_ROOK] |= addRowsAndColumnsToMask8x8(fromMask8x8, 0, 6);
-        _jumpTable[fromSq8x8][PieceType::WHITE_ROOK] |= addRowsAndColumnsToMask8x8(fromMask8x8, 0, 7);
-        _jumpTable[fromSq8x8][PieceType::WHITE_ROOK] |= addRowsAndColumnsToMask8x8(fromMask8x8, 1, 0);
-        _jumpTable[fromSq8x8][PieceType::WHITE_ROOK] |= addRowsAndColumnsToMask8x8(fromMask8x8, 2, 0);
-        _jumpTable[fromSq8x8][PieceType::WHITE_ROOK] |= addRowsAndColumnsToMask8x8(fromMask8x8, 3, 0);
-        _jumpTable[fromSq8x8][PieceType::WHITE_ROOK] |= addRowsAndColumnsToMask8x8(fromMask8x8, 4, 0);
-        _jumpTable[fromSq8x8][PieceType::WHITE_ROOK] |= addRowsAndColumnsToMask8x8(fromMask8x8, 5, 0);
-        _jumpTable[fromSq8x8][PieceType::WHITE_ROOK] |= addRowsAndColumnsToMask8x8(fromMask8x8, 6, 0);
-        _jumpTable[fromSq8x8][PieceType::WHITE_ROOK] |= addRowsAndColumnsToMask8x8(fromMask8x8, 7, 0);
-        _jumpTable[fromSq8x8][PieceType::BLACK_ROOK] = _jumpTable[fromSq8x8][PieceType::WHITE_ROOK];
-
-        _jumpTable[fromSq8x8][PieceType::WHITE_QUEEN] = _jumpTable[fromSq8x8][PieceType::WHITE_ROOK] | _jumpTable[fromSq8x8][PieceType::WHITE_BISHOP];
-        _jumpTable[fromSq8x8][PieceType::BLACK_QUEEN] = _jumpTable[fromSq8x8][PieceType::WHITE_QUEEN];
-
-        _jumpTable[fromSq8x8][PieceType::WHITE_KING] |= addRowsAndColumnsToMask8x8(fromMask8x8, -1, -1);
-        _jumpTable[fromSq8x8][PieceType::WHITE_KING] |= addRowsAndColumnsToMask8x8(fromMask8x8, -1, 0);
-        _jumpTable[fromSq8x8][PieceType::WHITE_KING] |= addRowsAndColumnsToMask8x8(fromMask8x8, -1, 1);
-        _jumpTable[fromSq8x8][PieceType::WHITE_KING] |= addRowsAndColumnsToMask8x8(fromMask8x8, 0, -1);
-        _jumpTable[fromSq8x8][PieceType::WHITE_KING] |= addRowsAndColumnsToMask8x8(fromMask8x8, 0, 1);
-        _jumpTable[fromSq8x8][PieceType::WHITE_KING] |= addRowsAndColumnsToMask8x8(fromMask8x8, 1, -1);
-        _jumpTable[fromSq8x8][PieceType::WHITE_KING] |= addRowsAndColumnsToMask8x8(fromMask8x8, 1, 0);
-        _jumpTable[fromSq8x8][PieceType::WHITE_KING] |= addRowsAndColumnsToMask8x8(fromMask8x8, 1, 1);
-        _jumpTable[fromSq8x8][PieceType::BLACK_KING] = _jumpTable[fromSq8x8][PieceType::WHITE_KING];
-    }
+/**
+ * Magic factors mapping every relevant occupancy of a field onto a collision-free index.
+ * Found by a trial-and-error search over sparse random numbers.
+ */
+static const uint64_t bishopMagicFactors[64] = {
+    0x10102002004A1420ull, 0x8020040400584008ull, 0x10510800811201C8ull, 0x5204042080000088ull,
+    0x2204106880000002ull, 0x1401042004000000ull, 0x0400880410042004ull, 0x0028208200A02020ull,
+    0x1500241990010E00ull, 0x8001200182020A40ull, 0x40004101030B0000ull, 0x8002041042000100ull,
+    0x4010011041020038ull, 0x0000010421044000ull, 0x1500210808020A00ull, 0x8000088400880520ull,
+    0x0405004010040100ull, 0x1005823210040108ull, 0x2708008102040011ull, 0x4048200404009100ull,
+    0x0018104101400024ull, 0x0003000601190101ull, 0x8004803108491000ull, 0x8014241200820800ull,
+    0x0006E080100C3040ull, 0x0501044A11041800ull, 0x9020300008004045ull, 0x0894080000220040ull,
+    0x1001010083104000ull, 0x5004030040900080ull, 0x000400422C012400ull, 0x0002128698404812ull,
+    0x1010108404900440ull, 0x0928021182084100ull, 0x2006080409020024ull, 0x1010202020180080ull,
+    0xA010008200202200ull, 0x2098015100019004ull, 0x0002041440810811ull, 0x802A02020000B098ull,
+    0x0009015090004060ull, 0x4000821082081001ull, 0x0100210040420800ull, 0x0800004010488A00ull,
+    0x2000081104004040ull, 0x4C8E029015000082ull, 0x0420340322224842ull, 0x1298260043400210ull,
+    0x0000822802400008ull, 0x00008A0101600000ull, 0x3040003412080021ull, 0x3040290220884800ull,
+    0x4A1500401041004Aull, 0x8010200282020781ull, 0x0020203142209091ull, 0x0070300600902110ull,
+    0x0040808800B62048ull, 0x0000810400C44420ull, 0x00080400440C0441ull, 0x8340080020840411ull,
+    0x0000000104208200ull, 0x0000800810D00080ull, 0x0400530411080200ull, 0x4040702400932244ull
+};
+
+static const uint64_t rookMagicFactors[64] = {
+    0x1080004008801020ull, 0x0840092002C03000ull, 0x1900200010400900ull, 0x0880100008000480ull,
+    0x4200100420080200ull, 0x8100020100080400ull, 0x0200040110886200ull, 0x0200008040220411ull,
+    0x0404800084400220ull, 0x0000401000402000ull, 0x0086001081220440ull, 0x0408800800100280ull,
+    0x000A001201040820ull, 0x8848800200840080ull, 0x4001000100040200ull, 0x0442000102105084ull,
+    0x9080010020804100ull, 0x0040404000201009ull, 0x0000808010002009ull, 0x2200090021D00100ull,
+    0x0008008008040080ull, 0x0004004002010040ull, 0x0011040008015042ull, 0x00000A0001768104ull,
+    0x0000800080204009ull, 0x2010004140002001ull, 0x9800200280100080ull, 0x1000100080080080ull,
+    0x0442000A00049020ull, 0x2100040080020080ull, 0x0800120400900148ull, 0x0010040A00128541ull,
+    0x2800804000800030ull, 0x1010002000400041ull, 0x4000200011004100ull, 0x0610008410800800ull,
+    0x0400802402800800ull, 0xC100020080800400ull, 0x0002000802000401ull, 0x0182085882000401ull,
+    0x0220204000808000ull, 0x2860100040024022ull, 0x0001002004110040ull, 0x99101042000A0020ull,
+    0x0004080004008080ull, 0x0010040002008080ull, 0x2012004881020004ull, 0x8300842444820011ull,
+    0x0088403882010200ull, 0x0820400080210100ull, 0x0110910040A00300ull, 0x0801100280080480ull,
+    0x0242009008200600ull, 0x1002000489500200ull, 0x0040800200010080ull, 0x0091800041000080ull,
+    0x0000209300488001ull, 0x04C1002414824001ull, 0x020020000B001041ull, 0x7000100004200901ull,
+    0x8002002004100802ull, 0x30010002084C0007ull, 0x0888221800813004ull, 0x4000002840840112ull
+};
 
 
-    std::memset(&_emptyMaskTable, 0, sizeof(_emptyMaskTable));
+/**
+ * Row and column deltas of the directions sliding pieces can move in.
+ */
+static const int8_t bishopDirections[4][2] = {{1, 1}, {1, -1}, {-1, 1}, {-1, -1}};
+static const int8_t rookDirections[4][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
 
-    for(uint8_t fromSq0x88 = 0; fromSq0x88 < 120; fromSq0x88++) {
 
-        uint8_t fromSq8x8 = sq8x8BySq0x88(fromSq0x88);
+// rays[sq8x8][direction] - fields from sq8x8 (exclusive) to the border of the board in each of four directions
+typedef std::array<std::array<uint64_t, 4>, 64> TRaysArray;
 
-        // north
-        for(uint8_t toSq0x88 = fromSq0x88 + 32; sq0x88Valid(toSq0x88); toSq0x88 += 16) {
 
-            uint8_t toSq8x8 = sq8x8BySq0x88(toSq0x88);
-            uint8_t lastToSq8x8 = sq8x8BySq0x88(toSq0x88 - 16);
+/**
+ * Walks from every field into the given directions up to the border of the board.
+ */
+static TRaysArray computeRays(const int8_t directions[4][2]) {
 
-            _emptyMaskTable[fromSq8x8][toSq8x8] = _emptyMaskTable[fromSq8x8][lastToSq8x8] | mask8x8BySq0x88(toSq0x88 - 16);
-        }
+    TRaysArray rays;
 
-        // north-east
-        for(uint8_t toSq0x88 = fromSq0x88 + 34; sq0x88Valid(toSq0x88); toSq0x88 += 17) {
+    for(uint8_t sq8x8 = 0; sq8x8 < 64; sq8x8++) {
 
-            uint8_t toSq8x8 = sq8x8BySq0x88(toSq0x88);
-            uint8_t lastToSq8x8 = sq8x8BySq0x88(toSq0x88 - 17);
+        for(uint8_t direction = 0; direction < 4; direction++) {
 
-            _emptyMaskTable[fromSq8x8][toSq8x8] = _emptyMaskTable[fromSq8x8][lastToSq8x8] | mask8x8BySq0x88(toSq0x88 - 17);
-        }
+            int row = rowBySq8x8(sq8x8) + directions[direction][0];
+            int column = columnBySq8x8(sq8x8) + directions[direction][1];
 
-        // east
-        for(uint8_t toSq0x88 = fromSq0x88 + 2; sq0x88Valid(toSq0x88); toSq0x88 += 1) {
+            rays[sq8x8][direction] = 0;
 
-            uint8_t toSq8x8 = sq8x8BySq0x88(toSq0x88);
-            uint8_t lastToSq8x8 = sq8x8BySq0x88(toSq0x88 - 1);
+            for(; row >= 0 && row < 8 && column >= 0 && column < 8; row += directions[direction][0], column += directions[direction][1]) {
 
-            _emptyMaskTable[fromSq8x8][toSq8x8] = _emptyMaskTable[fromSq8x8][lastToSq8x8] | mask8x8BySq0x88(toSq0x88 - 1);
+                rays[sq8x8][direction] |= mask8x8ByRowAndColumn(row, column);
+            }
         }
+    }
 
-        // south-east
-        for(uint8_t toSq0x88 = fromSq0x88 - 30; sq0x88Valid(toSq0x88); toSq0x88 -= 15) {
+    return rays;
+}
 
-            uint8_t toSq8x8 = sq8x8BySq0x88(toSq0x88);
-            uint8_t lastToSq8x8 = sq8x8BySq0x88(toSq0x88 + 15);
 
-            _emptyMaskTable[fromSq8x8][toSq8x8] = _emptyMaskTable[fromSq8x8][lastToSq8x8] | mask8x8BySq0x88(toSq0x88 + 15);
-        }
+/**
+ * Computes the attacks of a sliding piece: every ray is cut off behind the nearest occupied field on it.
+ */
+static uint64_t computeSlidingAttacks(uint8_t sq8x8, uint64_t occupiedMask8x8, const int8_t directions[4][2], const TRaysArray &rays) {
 
-        // south
-        for(uint8_t toSq0x88 = fromSq0x88 - 32; sq0x88Valid(toSq0x88); toSq0x88 -= 16) {
+    uint64_t attacksMask8x8 = 0;
 
-            uint8_t toSq8x8 = sq8x8BySq0x88(toSq0x88);
-            uint8_t lastToSq8x8 = sq8x8BySq0x88(toSq0x88 + 16);
+    for(uint8_t direction = 0; direction < 4; direction++) {
 
-            _emptyMaskTable[fromSq8x8][toSq8x8] = _emptyMaskTable[fromSq8x8][lastToSq8x8] | mask8x8BySq0x88(toSq0x88 + 16);
-        }
+        uint64_t rayMask8x8 = rays[sq8x8][direction];
+        uint64_t blockersMask8x8 = rayMask8x8 & occupiedMask8x8;
 
-        // south-west
-        for(uint8_t toSq0x88 = fromSq0x88 - 34; sq0x88Valid(toSq0x88); toSq0x88 -= 17) {
+        if(blockersMask8x8) {
 
-            uint8_t toSq8x8 = sq8x8BySq0x88(toSq0x88);
-            uint8_t lastToSq8x8 = sq8x8BySq0x88(toSq0x88 + 17);
+            // nearest blocker is the lowest field for rays towards h8 and the highest one otherwise
+            bool ascending = 8 * directions[direction][0] + directions[direction][1] > 0;
+            uint8_t blockerSq8x8 = ascending ? __builtin_ctzll(blockersMask8x8) : 63 - __builtin_clzll(blockersMask8x8);
 
-            _emptyMaskTable[fromSq8x8][toSq8x8] = _emptyMaskTable[fromSq8x8][lastToSq8x8] | mask8x8BySq0x88(toSq0x88 + 17);
+            rayMask8x8 &= ~rays[blockerSq8x8][direction];
         }
 
-        // west
-        for(uint8_t toSq0x88 = fromSq0x88 - 2; sq0x88Valid(toSq0x88); toSq0x88 -= 1) {
+        attacksMask8x8 |= rayMask8x8;
+    }
+
+    return attacksMask8x8;
+}
 
-            uint8_t toSq8x8 = sq8x8BySq0x88(toSq0x88);
-            uint8_t lastToSq8x8 = sq8x8BySq0x88(toSq0x88 + 1);
 
-            _emptyMaskTable[fromSq8x8][toSq8x8] = _emptyMaskTable[fromSq8x8][lastToSq8x8] | mask8x8BySq0x88(toSq0x88 + 1);
-        }
+/**
+ * Computes the fields whose occupancy affects the attacks of a sliding piece.
+ * The last field of every ray never blocks anything and is therefore left out.
+ */
+static uint64_t computeRelevantOccupancyMask(uint8_t sq8x8, const int8_t directions[4][2]) {
 
-        // north-west
-        for(uint8_t toSq0x88 = fromSq0x88 + 30; sq0x88Valid(toSq0x88); toSq0x88 += 15) {
+    uint64_t relevantMask8x8 = 0;
 
-            uint8_t toSq8x8 = sq8x8BySq0x88(toSq0x88);
-            uint8_t lastToSq8x8 = sq8x8BySq0x88(toSq0x88 - 15);
+    for(uint8_t direction = 0; direction < 4; direction++) {
 
-            _emptyMaskTable[fromSq8x8][toSq8x8] = _emptyMaskTable[fromSq8x8][lastToSq8x8] | mask8x8BySq0x88(toSq0x88 - 15);
-        }
+        uint64_t toMask8x8 = addRowsAndColumnsToMask8x8(mask8x8BySq8x8(sq8x8), directions[direction][0], directions[direction][1]);
 
+        while(toMask8x8 && addRowsAndColumnsToMask8x8(toMask8x8, directions[direction][0], directions[direction][1])) {
 
-        // jump to next row if in last column
-        fromSq0x88 += ((fromSq0x88 + 1) & uint8_t(8));
+            relevantMask8x8 |= toMask8x8;
+            toMask8x8 = addRowsAndColumnsToMask8x8(toMask8x8, directions[direction][0], directions[direction][1]);
+        }
     }
 
+    return relevantMask8x8;
+}
 
-    std::memset(&_opponentRequiredMaskTable, 0, sizeof(_opponentRequiredMaskTable));
 
-    for(uint8_t fromSq8x8 = 0; fromSq8x8 < 63; fromSq8x8++) {
+/**
+ * Fills the magic entries and attack table of one sliding piece type.
+ */
+template<size_t attackTableSize>
+static void initializeMagics(std::array<Magic, 64> &magics, std::array<uint64_t, attackTableSize> &attackTable, const uint64_t magicFactors[64], const int8_t directions[4][2], SliderIndexing sliderIndexing) {
+
+    TRaysArray rays = computeRays(directions);
+    uint32_t offset = 0;
+
+    for(uint8_t sq8x8 = 0; sq8x8 < 64; sq8x8++) {
 
-        uint64_t fromMask8x8 = mask8x8BySq8x8(fromSq8x8);
+        Magic &magic = magics[sq8x8];
 
-        _opponentRequiredMaskTable[fromSq8x8][PieceType::WHITE_PAWN] |= addRowsAndColumnsToMask8x8(fromMask8x8, 1, -1);
-        _opponentRequiredMaskTable[fromSq8x8][PieceType::WHITE_PAWN] |= addRowsAndColumnsToMask8x8(fromMask8x8, 1, 1);
-        _opponentRequiredMaskTable[fromSq8x8][PieceType::WHITE_PAWN] |= addRowsAndColumnsToMask8x8(fromMask8x8, 0, -1);
-        _opponentRequiredMaskTable[fromSq8x8][PieceType::WHITE_PAWN] |= addRowsAndColumnsToMask8x8(fromMask8x8, 0, 1);
+        magic.mask = computeRelevantOccupancyMask(sq8x8, directions);
+        magic.magic = magicFactors[sq8x8];
+        magic.shift = 64 - SET_BITS_64(magic.mask);
+        magic.offset = offset;
 
-        _opponentRequiredMaskTable[fromSq8x8][PieceType::BLACK_PAWN] |= addRowsAndColumnsToMask8x8(fromMask8x8, -1, -1);
-        _opponentRequiredMaskTable[fromSq8x8][PieceType::BLACK_PAWN] |= addRowsAndColumnsToMask8x8(fromMask8x8, -1, 1);
-        _opponentRequiredMaskTable[fromSq8x8][PieceType::BLACK_PAWN] |= addRowsAndColumnsToMask8x8(fromMask8x8, 0, -1);
-        _opponentRequiredMaskTable[fromSq8x8][PieceType::BLACK_PAWN] |= addRowsAndColumnsToMask8x8(fromMask8x8, 0, 1);
+        // enumerate all subsets of the relevant occupancy mask (carry-rippler)
+        uint64_t occupiedMask8x8 = 0;
+
+        do {
+
+            attackTable[magic.getIndex(occupiedMask8x8, sliderIndexing)] = computeSlidingAttacks(sq8x8, occupiedMask8x8, directions, rays);
+            occupiedMask8x8 = (occupiedMask8x8 - magic.mask) & magic.mask;
+        }
+        while(occupiedMask8x8);
+
+        offset += uint32_t(1) << SET_BITS_64(magic.mask);
     }
+}
+
+
+bool MoveGenerator::isPextSupported() {
+
+#if defined(__x86_64__)
+
+    unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+
+    return __get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) && (ebx & bit_BMI2);
+
+#else
+
+    return false;
+
+#endif
+}
+
+
+bool MoveGenerator::isPextFast() {
+
+    if(!isPextSupported()) return false;
+
+#if defined(__x86_64__)
+
+    unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+
+    // vendor "AuthenticAMD"
+    __get_cpuid(0, &eax, &ebx, &ecx, &edx);
+
+    if(ebx != 0x68747541 || ecx != 0x444d4163 || edx != 0x69746e65) return true;
+
+    // family 17h (zen, zen+, zen2) implements pext in microcode with a latency of up to ~300 cycles
+    __get_cpuid(1, &eax, &ebx, &ecx, &edx);
+
+    return ((eax >> 8) & 0xF) + ((eax >> 20) & 0xFF) != 0x17;
+
+#else
+
+    return false;
+
+#endif
+}
+
+
+void MoveGenerator::initialize() {
+
+    initialize(isPextFast() ? SliderIndexing::PEXT : SliderIndexing::MAGIC);
+}
+
+
+void MoveGenerator::initialize(SliderIndexing sliderIndexing) {
+
+    initializeMagics(_bishopMagics, _bishopAttackTable, bishopMagicFactors, bishopDirections, sliderIndexing);
+    initializeMagics(_rookMagics, _rookAttackTable, rookMagicFactors, rookDirections, sliderIndexing);
+
+    _sliderIndexing = sliderIndexing;
 }
\ No newline at end of file
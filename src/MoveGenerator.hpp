@@ -24,71 +24,459 @@
 #include "Constants.hpp"
 #include "Move.hpp"
 #include "PositionMath.hpp"
+#include "Profiler.hpp"
+
+
+/**
+ * Ways to map the relevant occupancy of a sliding piece onto an attack table index.
+ */
+enum SliderIndexing : uint8_t {
+
+    MAGIC,      // multiplication with a magic factor and shift (portable)
+    PEXT        // parallel bit extract (requires BMI2)
+};
+
+
+/**
+ * Subsets of pseudo-legal moves that can be generated separately.
+ */
+enum GenerationType : uint8_t {
+
+    ALL,        // captures and quiet moves
+    CAPTURES,   // moves onto fields occupied by the other player
+    QUIETS      // moves onto empty fields
+};
+
+
+/**
+ * Magic bitboard entry of a single field for a single sliding piece type.
+ */
+struct Magic {
+
+    uint64_t mask;
+    uint64_t magic;
+    uint32_t offset;
+    uint8_t shift;
+
+    template<SliderIndexing sliderIndexing>
+    FORCE_INLINE uint32_t getIndex(uint64_t occupiedMask8x8) const {
+
+        return offset + uint32_t((sliderIndexing == SliderIndexing::PEXT) ? pext64(occupiedMask8x8, mask) : (((occupiedMask8x8 & mask) * magic) >> shift));
+    }
+
+    FORCE_INLINE uint32_t getIndex(uint64_t occupiedMask8x8, SliderIndexing sliderIndexing) const {
+
+        return (sliderIndexing == SliderIndexing::PEXT) ? getIndex<SliderIndexing::PEXT>(occupiedMask8x8) : getIndex<SliderIndexing::MAGIC>(occupiedMask8x8);
+    }
+};
 
 
 class MoveGenerator {
 
-protected:
+public:
 
-    // 4096 moves is the theoretical maximum number of possible 1-piece moves on a 64*64 board
+    // 218 is the maximum number of legal moves in any position, pseudo-legal moves get some headroom on top
     // an array instead of a vector is used to avoid branching during boundary-check when appending a move
-    typedef std::array<Move, 4096> TMovesArray;
+    typedef std::array<Move, 256> TMovesArray;
 
 
+protected:
+
     // generated moves to be made accessible via the streaming interface
-    TMovesArray _moves;
+    // the array is owned by the caller (e.g. the search stack) to keep generators small
+    TMovesArray &_moves;
     TMovesArray::size_type _totalMoveCount = 0;
     TMovesArray::size_type _currentMove = 0;
 
 
-    // Pre-generated jump table
+    // Jump tables generated at compile time (see LookupTables)
     // _jumpTable[fromSq8x8][fromPieceType] - valid targets as mask8x8
     // _emptyMaskTable[fromSq8x8][toSq8x8] - fields that need to be empty as mask8x8
     // _opponentRequiredMaskTable[fromSq8x8][fromPieceType] - fields that need an opponent piece (pawn attacks)
-    static std::array<std::array<uint64_t, 256>, 64> _jumpTable;
-    static std::array<std::array<uint64_t, 64>, 64> _emptyMaskTable;
-    static std::array<std::array<uint64_t, 256>, 64> _opponentRequiredMaskTable;
+    static const std::array<std::array<uint64_t, 256>, 64> _jumpTable;
+    static const std::array<std::array<uint64_t, 64>, 64> _emptyMaskTable;
+    static const std::array<std::array<uint64_t, 256>, 64> _opponentRequiredMaskTable;
+
+
+    // Magic bitboard tables for sliding pieces
+    // _bishopMagics[fromSq8x8] / _rookMagics[fromSq8x8] - relevant occupancy mask, magic factor, shift and offset
+    // _bishopAttackTable[offset + index] / _rookAttackTable[offset + index] - attack sets as mask8x8
+    // with index = ((occupied & mask) * magic) >> shift or pext(occupied, mask) (see Magic::getIndex())
+    // _sliderIndexing - indexing the attack tables have been filled for (selected once in initialize())
+    static std::array<Magic, 64> _bishopMagics;
+    static std::array<Magic, 64> _rookMagics;
+    static std::array<uint64_t, 5248> _bishopAttackTable;
+    static std::array<uint64_t, 102400> _rookAttackTable;
+    static SliderIndexing _sliderIndexing;
+
+
+    /**
+     * Appends the given move.
+     * Moves beyond the capacity of the moves array are dropped, constructed positions may have more pseudo-legal moves.
+     */
+    FORCE_INLINE void appendMove(const Move &move) {
+
+        if(_totalMoveCount < _moves.size()) {
+
+            _moves[_totalMoveCount++] = move;
+        }
+    }
+
+
+    /**
+     * Appends a move for each target in the given mask8x8.
+     */
+    FORCE_INLINE void addMoves(uint8_t fromSq8x8, uint64_t targetsMask8x8) {
+
+        while(targetsMask8x8) {
+
+            appendMove(Move(fromSq8x8, popSq8x8(targetsMask8x8)));
+        }
+    }
+
+
+    /**
+     * Appends a move for each target in the given mask8x8 coming from the field delta8x8 behind it.
+     */
+    template<int8_t delta8x8>
+    FORCE_INLINE void addMovesByDelta(uint64_t targetsMask8x8) {
+
+        while(targetsMask8x8) {
+
+            uint8_t toSq8x8 = popSq8x8(targetsMask8x8);
+
+            appendMove(Move(uint8_t(toSq8x8 - delta8x8), toSq8x8));
+        }
+    }
+
+
+    /**
+     * Appends pawn moves of the given player for the given generation type.
+     * All pawns are moved at once by shifting the pawns mask8x8, moves are produced from the resulting targets.
+     */
+    template<GenerationType generationType, Player player>
+    FORCE_INLINE void addPawnMoves(const Board &board) {
+
+        constexpr int8_t forward = IS_WHITE(player) ? 8 : -8;
+        constexpr uint64_t doublePushRowMask8x8 = mask8x8ByRow(IS_WHITE(player) ? 2 : 5);
+
+        uint64_t pawnsMask8x8 = board.getPiecesMask<player>(PieceType::PAWN);
+
+        if(generationType != GenerationType::QUIETS) {
+
+            uint64_t opponentMask8x8 = board.getPlayerPiecesMask<GET_OTHER_PLAYER(player)>();
+
+            addMovesByDelta<forward - 1>(shiftMask8x8<forward - 1>(pawnsMask8x8 & ~mask8x8ByColumn(0)) & opponentMask8x8);
+            addMovesByDelta<forward + 1>(shiftMask8x8<forward + 1>(pawnsMask8x8 & ~mask8x8ByColumn(7)) & opponentMask8x8);
+        }
+
+        if(generationType != GenerationType::CAPTURES) {
+
+            uint64_t singlePushesMask8x8 = shiftMask8x8<forward>(pawnsMask8x8) & board.getNotOccupiedMask();
+
+            addMovesByDelta<forward>(singlePushesMask8x8);
+            addMovesByDelta<2 * forward>(shiftMask8x8<forward>(singlePushesMask8x8 & doublePushRowMask8x8) & board.getNotOccupiedMask());
+        }
+    }
+
+
+    /**
+     * @return Fields non-pawn pieces of the given player may move to for the given generation type as mask8x8.
+     */
+    template<GenerationType generationType, Player player>
+    static FORCE_INLINE uint64_t getTargetsMask(const Board &board) {
+
+        return (generationType == GenerationType::CAPTURES) ? board.getPlayerPiecesMask<GET_OTHER_PLAYER(player)>() : ((generationType == GenerationType::QUIETS) ? board.getNotOccupiedMask() : ~board.getPlayerPiecesMask<player>());
+    }
+
+
+    /**
+     * @return Targets of a pawn of the given player on the given field for the given generation type as mask8x8.
+     * Move generation uses addPawnMoves(), this is used to validate single moves.
+     */
+    template<GenerationType generationType, Player player>
+    FORCE_INLINE uint64_t getPawnTargets(Board &board, uint8_t fromSq8x8) {
+
+        constexpr PieceType pawn = static_cast<PieceType>(player | PieceType::PAWN);
+
+        uint64_t capturesMask8x8 = 0;
+        uint64_t pushesMask8x8 = 0;
+
+        if(generationType != GenerationType::QUIETS) {
+
+            capturesMask8x8 = _jumpTable[fromSq8x8][pawn] & _opponentRequiredMaskTable[fromSq8x8][pawn] & board.getPlayerPiecesMask<GET_OTHER_PLAYER(player)>();
+        }
+
+        if(generationType != GenerationType::CAPTURES) {
+
+            pushesMask8x8 = removeBlockedTargets(board, fromSq8x8, _jumpTable[fromSq8x8][pawn] & ~_opponentRequiredMaskTable[fromSq8x8][pawn] & board.getNotOccupiedMask());
+        }
+
+        return capturesMask8x8 | pushesMask8x8;
+    }
+
+
+    /**
+     * Removes all targets from the given mask8x8 that are hidden behind an occupied field.
+     */
+    FORCE_INLINE uint64_t removeBlockedTargets(Board &board, uint8_t fromSq8x8, uint64_t targetsMask8x8) {
+
+        uint64_t remainingMask8x8 = targetsMask8x8;
+
+        while(remainingMask8x8) {
+
+            uint8_t toSq8x8 = popSq8x8(remainingMask8x8);
+
+            if(_emptyMaskTable[fromSq8x8][toSq8x8] & board.getOccupiedMask()) {
+
+                targetsMask8x8 ^= mask8x8BySq8x8(toSq8x8);
+            }
+        }
+
+        return targetsMask8x8;
+    }
 
 
 public:
 
     /**
-     * Pre-generate jump tables.
+     * Generated moves are written into the given array.
+     */
+    explicit MoveGenerator(TMovesArray &moves) : _moves(moves) {}
+
+
+    /**
+     * Pre-generate sliding piece attack tables (all other tables are constant).
+     * Uses PEXT indexing if the CPU supports fast PEXT and magic indexing otherwise.
      */
     static void initialize();
 
+    /**
+     * Pre-generate sliding piece attack tables for the given indexing.
+     * PEXT indexing must only be requested if isPextSupported().
+     */
+    static void initialize(SliderIndexing sliderIndexing);
+
 
     /**
-     * Generates all pseudo-legal moves.
-     *
-     * todo:
-     *  - add casteling
-     *  - add last-move-check for pawn en-passent captures
-     *  - force unroll_loop? (only inner/outer?)
-     *  - add piece-traversing version to speed up generation process in end-games
+     * @return Whether the CPU supports the BMI2 PEXT instruction (cpuid).
+     */
+    static bool isPextSupported();
+
+    /**
+     * @return Whether PEXT is supported and implemented in hardware (AMD Zen/Zen2 execute it in microcode).
+     */
+    static bool isPextFast();
+
+
+    /**
+     * @return Indexing the sliding piece attack tables have been filled for.
+     */
+    static SliderIndexing getSliderIndexing() {
+
+        return _sliderIndexing;
+    }
+
+
+    /**
+     * @return Attacked fields of a bishop on the given field as mask8x8 including occupied fields (captures and own pieces).
+     */
+    static FORCE_INLINE uint64_t getBishopAttacks(uint8_t sq8x8, uint64_t occupiedMask8x8) {
+
+        return (_sliderIndexing == SliderIndexing::PEXT) ? getBishopAttacks<SliderIndexing::PEXT>(sq8x8, occupiedMask8x8) : getBishopAttacks<SliderIndexing::MAGIC>(sq8x8, occupiedMask8x8);
+    }
+
+    template<SliderIndexing sliderIndexing>
+    static FORCE_INLINE uint64_t getBishopAttacks(uint8_t sq8x8, uint64_t occupiedMask8x8) {
+
+        return _bishopAttackTable[_bishopMagics[sq8x8].template getIndex<sliderIndexing>(occupiedMask8x8)];
+    }
+
+
+    /**
+     * @return Attacked fields of a rook on the given field as mask8x8 including occupied fields (captures and own pieces).
+     */
+    static FORCE_INLINE uint64_t getRookAttacks(uint8_t sq8x8, uint64_t occupiedMask8x8) {
+
+        return (_sliderIndexing == SliderIndexing::PEXT) ? getRookAttacks<SliderIndexing::PEXT>(sq8x8, occupiedMask8x8) : getRookAttacks<SliderIndexing::MAGIC>(sq8x8, occupiedMask8x8);
+    }
+
+    template<SliderIndexing sliderIndexing>
+    static FORCE_INLINE uint64_t getRookAttacks(uint8_t sq8x8, uint64_t occupiedMask8x8) {
+
+        return _rookAttackTable[_rookMagics[sq8x8].template getIndex<sliderIndexing>(occupiedMask8x8)];
+    }
+
+
+    /**
+     * @return Attacked fields of a queen on the given field as mask8x8 including occupied fields (captures and own pieces).
+     */
+    static FORCE_INLINE uint64_t getQueenAttacks(uint8_t sq8x8, uint64_t occupiedMask8x8) {
+
+        return getBishopAttacks(sq8x8, occupiedMask8x8) | getRookAttacks(sq8x8, occupiedMask8x8);
+    }
+
+
+    /**
+     * @return Pieces of both players attacking the given field as mask8x8 with sliding attacks computed for the given occupancy.
+     */
+    static FORCE_INLINE uint64_t getAttackersMask(const Board &board, uint8_t sq8x8, uint64_t occupiedMask8x8) {
+
+        return (_jumpTable[sq8x8][PieceType::BLACK_PAWN] & _opponentRequiredMaskTable[sq8x8][PieceType::BLACK_PAWN] & board.getWhitePawnsMask())
+            | (_jumpTable[sq8x8][PieceType::WHITE_PAWN] & _opponentRequiredMaskTable[sq8x8][PieceType::WHITE_PAWN] & board.getBlackPawnsMask())
+            | (_jumpTable[sq8x8][PieceType::WHITE_KNIGHT] & (board.getWhiteKnightsMask() | board.getBlackKnightsMask()))
+            | (_jumpTable[sq8x8][PieceType::WHITE_KING] & (board.getWhiteKingMask() | board.getBlackKingMask()))
+            | (getBishopAttacks(sq8x8, occupiedMask8x8) & (board.getWhiteBishopsMask() | board.getBlackBishopsMask() | board.getWhiteQueenMask() | board.getBlackQueenMask()))
+            | (getRookAttacks(sq8x8, occupiedMask8x8) & (board.getWhiteRooksMask() | board.getBlackRooksMask() | board.getWhiteQueenMask() | board.getBlackQueenMask()));
+    }
+
+
+    /**
+     * @return Whether the king of the given player is attacked by the other player.
+     */
+    template<Player player>
+    static FORCE_INLINE bool isInCheck(const Board &board) {
+
+        uint64_t kingMask8x8 = board.getPiecesMask<player>(PieceType::KING);
+
+        return kingMask8x8 && (getAttackersMask(board, sq8x8ByMask8x8(kingMask8x8), board.getOccupiedMask()) & board.getPlayerPiecesMask<GET_OTHER_PLAYER(player)>());
+    }
+
+
+    /**
+     * @return Whether the king of the current player is attacked by the other player.
+     */
+    static FORCE_INLINE bool isInCheck(const Board &board) {
+
+        return board.whiteToMove() ? isInCheck<Player::WHITE>(board) : isInCheck<Player::BLACK>(board);
+    }
+
+
+    /**
+     * Appends pseudo-legal moves of the given type by traversing the pieces of the given player.
+     * Cost scales with the number of pieces and generated moves instead of all 64*64 square pairs.
+     * Bitboard indices and jump table columns are compile-time constants for the given player.
+     */
+    template<GenerationType generationType, Player player>
+    FORCE_INLINE void addMovesByPieces(Board &board) {
+
+        PROFILE_SCOPE(GENERATE_MOVES);
+
+        uint64_t targetsMask8x8 = getTargetsMask<generationType, player>(board);
+        uint64_t piecesMask8x8;
+
+
+        // pawns capture diagonally and push onto empty fields only
+        addPawnMoves<generationType, player>(board);
+
+
+        // leaping pieces (jump tables are the same for both players)
+        piecesMask8x8 = board.getPiecesMask<player>(PieceType::KNIGHT);
+
+        while(piecesMask8x8) {
+
+            uint8_t fromSq8x8 = popSq8x8(piecesMask8x8);
+
+            addMoves(fromSq8x8, _jumpTable[fromSq8x8][PieceType::WHITE_KNIGHT] & targetsMask8x8);
+        }
+
+        piecesMask8x8 = board.getPiecesMask<player>(PieceType::KING);
+
+        while(piecesMask8x8) {
+
+            uint8_t fromSq8x8 = popSq8x8(piecesMask8x8);
+
+            addMoves(fromSq8x8, _jumpTable[fromSq8x8][PieceType::WHITE_KING] & targetsMask8x8);
+        }
+
+
+        // sliding pieces
+        piecesMask8x8 = board.getPiecesMask<player>(PieceType::BISHOP);
+
+        while(piecesMask8x8) {
+
+            uint8_t fromSq8x8 = popSq8x8(piecesMask8x8);
+
+            addMoves(fromSq8x8, getBishopAttacks(fromSq8x8, board.getOccupiedMask()) & targetsMask8x8);
+        }
+
+        piecesMask8x8 = board.getPiecesMask<player>(PieceType::ROOK);
+
+        while(piecesMask8x8) {
+
+            uint8_t fromSq8x8 = popSq8x8(piecesMask8x8);
+
+            addMoves(fromSq8x8, getRookAttacks(fromSq8x8, board.getOccupiedMask()) & targetsMask8x8);
+        }
+
+        piecesMask8x8 = board.getPiecesMask<player>(PieceType::QUEEN);
+
+        while(piecesMask8x8) {
+
+            uint8_t fromSq8x8 = popSq8x8(piecesMask8x8);
+
+            addMoves(fromSq8x8, getQueenAttacks(fromSq8x8, board.getOccupiedMask()) & targetsMask8x8);
+        }
+    }
+
+
+    /**
+     * Appends pseudo-legal moves of the given type by traversing the pieces of the current player.
      */
-    FORCE_INLINE UNROLL_LOOPS TMovesArray::size_type generateMoves(Board &board) {
+    template<GenerationType generationType>
+    FORCE_INLINE void addMovesByPieces(Board &board) {
+
+        if(board.whiteToMove()) {
+
+            addMovesByPieces<generationType, Player::WHITE>(board);
+        }
+        else {
+
+            addMovesByPieces<generationType, Player::BLACK>(board);
+        }
+    }
+
+
+    /**
+     * Generates pseudo-legal moves of the given type by traversing the pieces of the current player.
+     */
+    template<GenerationType generationType = GenerationType::ALL>
+    FORCE_INLINE TMovesArray::size_type generateMovesByPieces(Board &board) {
+
+        _totalMoveCount = 0;
+        _currentMove = 0;
+
+        addMovesByPieces<generationType>(board);
+
+        return _totalMoveCount;
+    }
+
+
+    /**
+     * Generates all pseudo-legal moves by testing every (from, to) square pair against the jump tables.
+     * Kept as reference implementation to cross-check generateMovesByPieces().
+     */
+    FORCE_INLINE UNROLL_LOOPS TMovesArray::size_type generateMovesBySquarePairs(Board &board) {
+
+        PROFILE_SCOPE(GENERATE_MOVES);
 
         TMovesArray::size_type incrementor;
 
         _totalMoveCount = 0;
         _currentMove = 0;
 
-        for(uint8_t fromSq8x8 = 0; fromSq8x8 < 63; fromSq8x8++) {
+        for(uint8_t fromSq8x8 = 0; fromSq8x8 < 64; fromSq8x8++) {
 
             PieceType fromPieceType = board.getPieceBySq8x8(fromSq8x8);
 
-            for(uint8_t toSq8x8 = 0; toSq8x8 < 63; toSq8x8++) {
+            for(uint8_t toSq8x8 = 0; toSq8x8 < 64; toSq8x8++) {
 
                 PieceType toPieceType = board.getPieceBySq8x8(toSq8x8);
                 uint64_t toMask8x8 = mask8x8BySq8x8(toSq8x8);
 
 
                 // write current move
-                _moves[_totalMoveCount].movingPieceType = fromPieceType;
-                _moves[_totalMoveCount].capturedPieceType = toPieceType;
-                _moves[_totalMoveCount].fromSq0x88 = sq0x88BySq8x8(fromSq8x8);
-                _moves[_totalMoveCount].toSq0x88 = sq0x88BySq8x8(toSq8x8);
+                _moves[_totalMoveCount] = Move(fromSq8x8, toSq8x8);
 
 
                 // test for validity
@@ -111,10 +499,12 @@ public:
                 incrementor = incrementor >> HAS_SET_BITS_64(_emptyMaskTable[fromSq8x8][toSq8x8] & board.getOccupiedMask());
                 incrementor = incrementor >> HAS_SET_BITS_64(_opponentRequiredMaskTable[fromSq8x8][fromPieceType] & toMask8x8 & ~board.getOtherPlayerPiecesMask());
 
-                // check for empty field in front of pawn
-                incrementor = incrementor >> HAS_SET_BITS_64((fromPieceType == PieceType::WHITE_PAWN) && mask8x8BySq8x8(fromSq8x8 + 8) & board.getOccupiedMask());
-                incrementor = incrementor >> HAS_SET_BITS_64((fromPieceType == PieceType::BLACK_PAWN) && mask8x8BySq8x8(fromSq8x8 - 8) & board.getOccupiedMask());
+                // pawn pushes need an empty target field (fields in between are covered by the empty mask table)
+                incrementor = incrementor >> (IS_PAWN(fromPieceType) && HAS_SET_BITS_64(~_opponentRequiredMaskTable[fromSq8x8][fromPieceType] & toMask8x8 & board.getOccupiedMask()));
+
 
+                // the last entry of the moves array is overwritten once it is full
+                incrementor = incrementor >> (_totalMoveCount + 1 == _moves.size());
 
                 // go to next move if valid
                 _totalMoveCount += incrementor;
@@ -125,6 +515,64 @@ public:
     }
 
 
+    /**
+     * Generates all pseudo-legal moves.
+     *
+     * todo:
+     *  - add casteling
+     *  - add last-move-check for pawn en-passent captures
+     */
+    template<bool traversePieces = true>
+    FORCE_INLINE TMovesArray::size_type generateMoves(Board &board) {
+
+        return traversePieces ? generateMovesByPieces(board) : generateMovesBySquarePairs(board);
+    }
+
+
+    /**
+     * Generates all pseudo-legal captures.
+     */
+    FORCE_INLINE TMovesArray::size_type generateCaptures(Board &board) {
+
+        return generateMovesByPieces<GenerationType::CAPTURES>(board);
+    }
+
+
+    /**
+     * Checks whether the given move would be generated for the given board state with the given player to move.
+     * Used to validate moves from other sources like the transposition table before searching them.
+     */
+    template<Player player>
+    FORCE_INLINE bool isPseudoLegal(Board &board, const Move &move) {
+
+        uint8_t fromSq8x8 = move.getFromSq8x8();
+        PieceType fromPieceType = board.getPieceBySq8x8(fromSq8x8);
+        uint64_t targetsMask8x8;
+
+        if(move.getMoveType() != MoveType::NORMAL || IS_EMPTY(fromPieceType) || GET_PLAYER(fromPieceType) != player) return false;
+
+        switch(PIECE_TYPE(fromPieceType)) {
+
+            case PieceType::PAWN: targetsMask8x8 = getPawnTargets<GenerationType::ALL, player>(board, fromSq8x8); break;
+            case PieceType::BISHOP: targetsMask8x8 = getBishopAttacks(fromSq8x8, board.getOccupiedMask()); break;
+            case PieceType::ROOK: targetsMask8x8 = getRookAttacks(fromSq8x8, board.getOccupiedMask()); break;
+            case PieceType::QUEEN: targetsMask8x8 = getQueenAttacks(fromSq8x8, board.getOccupiedMask()); break;
+            default: targetsMask8x8 = _jumpTable[fromSq8x8][fromPieceType]; break;
+        }
+
+        return targetsMask8x8 & getTargetsMask<GenerationType::ALL, player>(board) & mask8x8BySq8x8(move.getToSq8x8());
+    }
+
+
+    /**
+     * Checks whether the given move would be generated for the given board state.
+     */
+    FORCE_INLINE bool isPseudoLegal(Board &board, const Move &move) {
+
+        return board.whiteToMove() ? isPseudoLegal<Player::WHITE>(board, move) : isPseudoLegal<Player::BLACK>(board, move);
+    }
+
+
     /**
      * Advance internal pointer
      */
@@ -0,0 +1,321 @@
+/**
+ * Redfish is an open-source chess engine.
+ * Copyright (C) 2016 Arne Groskurth
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <utility>
+
+#include "Board.hpp"
+#include "Evaluation.hpp"
+#include "Move.hpp"
+#include "MoveGenerator.hpp"
+
+
+/**
+ * Stages of the move picker. Moves of a stage are only generated once all moves of the previous stages have been searched.
+ */
+enum PickerStage : uint8_t {
+
+    PICK_HASH_MOVE,
+    PICK_CAPTURES,
+    PICK_KILLERS,
+    PICK_QUIETS,
+    PICK_DONE
+};
+
+
+/**
+ * Staged move generator handing out moves in the order they are expected to be best:
+ *
+ *  1. hash move (transposition table or principal variation)
+ *  2. captures by most valuable victim and least valuable attacker (MVV-LVA)
+ *  3. killer moves (quiet moves that caused a beta cutoff at the same ply)
+ *  4. other quiet moves by their butterfly history score
+ *
+ * Captures and quiet moves are only generated when the search gets to them, so nodes cutting off on the hash move
+ * or a capture never generate quiet moves. Within a stage the best remaining move is selected on each step (lazy
+ * selection sort). Moves of all stages are appended to the same moves array.
+ */
+class MovePicker : public MoveGenerator {
+
+public:
+
+    typedef std::array<int32_t, 256> TScoresArray;
+
+    // _history[whiteToMove][fromSq8x8][toSq8x8] - score of quiet moves that caused beta cutoffs
+    typedef std::array<std::array<std::array<int32_t, 64>, 64>, 2> THistoryTable;
+
+    typedef std::array<Move, 2> TKillersArray;
+
+
+    // history scores are kept below this bound
+    static const int32_t maxHistoryScore = 1 << 20;
+
+
+protected:
+
+    // scores of the generated moves (owned by the caller as the moves array)
+    TScoresArray &_scores;
+
+    Board *_board = nullptr;
+    const THistoryTable *_history = nullptr;
+
+    Move _hashMove;
+    TKillersArray _killers;
+
+    PickerStage _stage = PickerStage::PICK_DONE;
+    bool _capturesOnly = false;
+
+
+    static FORCE_INLINE int32_t getCaptureScore(const Board &board, const Move &move) {
+
+        return 16 * Evaluation::getPieceValue(board.getPieceBySq8x8(move.getToSq8x8())) - Evaluation::getPieceValue(board.getPieceBySq8x8(move.getFromSq8x8()));
+    }
+
+
+    /**
+     * Swaps the best scored of the remaining moves to the current position.
+     */
+    FORCE_INLINE void selectBest() {
+
+        TMovesArray::size_type bestMove = _currentMove;
+
+        for(TMovesArray::size_type i = _currentMove + 1; i < _totalMoveCount; i++) {
+
+            if(_scores[i] > _scores[bestMove]) bestMove = i;
+        }
+
+        std::swap(_moves[_currentMove], _moves[bestMove]);
+        std::swap(_scores[_currentMove], _scores[bestMove]);
+    }
+
+
+    /**
+     * @return Whether the given move has already been handed out in an earlier stage.
+     */
+    FORCE_INLINE bool isDuplicate(const Move &move) const {
+
+        return move == _hashMove || (_stage == PickerStage::PICK_QUIETS && (move == _killers[0] || move == _killers[1]));
+    }
+
+
+    /**
+     * Generates the moves of the next stage.
+     */
+    FORCE_INLINE void nextStage() {
+
+        switch(_stage) {
+
+            case PickerStage::PICK_HASH_MOVE: {
+
+                _stage = PickerStage::PICK_CAPTURES;
+
+                TMovesArray::size_type first = _totalMoveCount;
+
+                addMovesByPieces<GenerationType::CAPTURES>(*_board);
+
+                for(TMovesArray::size_type i = first; i < _totalMoveCount; i++) {
+
+                    _scores[i] = getCaptureScore(*_board, _moves[i]);
+                }
+
+                break;
+            }
+
+            case PickerStage::PICK_CAPTURES: {
+
+                if(_capturesOnly) {
+
+                    _stage = PickerStage::PICK_DONE;
+
+                    break;
+                }
+
+                _stage = PickerStage::PICK_KILLERS;
+
+                // killers are quiet moves of sibling positions and need to be validated
+                for(const Move &killer : _killers) {
+
+                    if(killer != _hashMove && isPseudoLegal(*_board, killer) && IS_EMPTY(_board->getPieceBySq8x8(killer.getToSq8x8()))) {
+
+                        appendMove(killer);
+                    }
+                }
+
+                break;
+            }
+
+            case PickerStage::PICK_KILLERS: {
+
+                _stage = PickerStage::PICK_QUIETS;
+
+                TMovesArray::size_type first = _totalMoveCount;
+                const std::array<std::array<int32_t, 64>, 64> &playerHistory = (*_history)[_board->whiteToMove()];
+
+                addMovesByPieces<GenerationType::QUIETS>(*_board);
+
+                for(TMovesArray::size_type i = first; i < _totalMoveCount; i++) {
+
+                    _scores[i] = playerHistory[_moves[i].getFromSq8x8()][_moves[i].getToSq8x8()];
+                }
+
+                break;
+            }
+
+            default:
+
+                _stage = PickerStage::PICK_DONE;
+        }
+    }
+
+
+    /**
+     * Moves on to the next move to be searched, generating further stages as needed.
+     */
+    FORCE_INLINE void findNextMove() {
+
+        while(true) {
+
+            if(_currentMove < _totalMoveCount) {
+
+                if(_stage == PickerStage::PICK_CAPTURES || _stage == PickerStage::PICK_QUIETS) selectBest();
+
+                if(_stage == PickerStage::PICK_HASH_MOVE || !isDuplicate(_moves[_currentMove])) return;
+
+                _currentMove++;
+            }
+            else if(_stage == PickerStage::PICK_DONE) {
+
+                return;
+            }
+            else {
+
+                nextStage();
+            }
+        }
+    }
+
+
+public:
+
+    MovePicker(TMovesArray &moves, TScoresArray &scores) : MoveGenerator(moves), _scores(scores) {}
+
+
+    /**
+     * Starts handing out all pseudo-legal moves beginning with the given hash move (if pseudo-legal).
+     */
+    FORCE_INLINE void init(Board &board, const Move &hashMove, const TKillersArray &killers, const THistoryTable &history) {
+
+        _board = &board;
+        _history = &history;
+        _hashMove = hashMove;
+        _killers = killers;
+        _capturesOnly = false;
+        _stage = PickerStage::PICK_HASH_MOVE;
+
+        _totalMoveCount = 0;
+        _currentMove = 0;
+
+        if(isPseudoLegal(board, hashMove)) {
+
+            appendMove(hashMove);
+        }
+
+        findNextMove();
+    }
+
+
+    /**
+     * Starts handing out pseudo-legal captures ordered by MVV-LVA.
+     */
+    FORCE_INLINE void initCaptures(Board &board) {
+
+        _board = &board;
+        _hashMove = Move(uint16_t(0));
+        _capturesOnly = true;
+        _stage = PickerStage::PICK_HASH_MOVE;
+
+        _totalMoveCount = 0;
+        _currentMove = 0;
+
+        findNextMove();
+    }
+
+
+    /**
+     * @return Stage of the current move.
+     */
+    FORCE_INLINE PickerStage getStage() const {
+
+        return _stage;
+    }
+
+
+    /**
+     * Advances to the next move.
+     */
+    FORCE_INLINE MovePicker & operator++() {
+
+        _currentMove++;
+
+        findNextMove();
+
+        return *this;
+    }
+
+
+    /**
+     * Rewards a quiet move that caused a beta cutoff at the given remaining depth.
+     * All scores are halved once the maximum is exceeded so that recent cutoffs outweigh old ones.
+     */
+    static FORCE_INLINE void updateHistory(THistoryTable &history, const Board &board, const Move &move, uint8_t depth) {
+
+        int32_t &score = history[board.whiteToMove()][move.getFromSq8x8()][move.getToSq8x8()];
+
+        score += int32_t(depth) * depth;
+
+        if(score > maxHistoryScore) {
+
+            for(auto &playerHistory : history) {
+
+                for(auto &fromHistory : playerHistory) {
+
+                    for(auto &toScore : fromHistory) {
+
+                        toScore /= 2;
+                    }
+                }
+            }
+        }
+    }
+
+
+    /**
+     * Remembers a quiet move that caused a beta cutoff as first killer of its ply.
+     */
+    static FORCE_INLINE void updateKillers(TKillersArray &killers, const Move &move) {
+
+        if(killers[0] != move) {
+
+            killers[1] = killers[0];
+            killers[0] = move;
+        }
+    }
+};
@@ -0,0 +1,98 @@
+/**
+ * Redfish is an open-source chess engine.
+ * Copyright (C) 2016 Arne Groskurth
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Options.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+
+void Options::parse(int argc, char **argv) {
+
+    for(int i = 1; i < argc; i++) {
+
+        std::string argument(argv[i]);
+        std::string::size_type separator = argument.find('=');
+
+        std::string name = argument.substr(0, separator);
+        std::string value = (separator == std::string::npos) ? "" : argument.substr(separator + 1);
+
+        if(name == "ParallelSearch") {
+
+            if(value == "LazySMP") {
+
+                parallelSearch = ParallelSearch::LAZY_SMP;
+            }
+            else if(value == "YBWC") {
+
+                parallelSearch = ParallelSearch::YBWC;
+            }
+            else {
+
+                std::cerr << "Invalid option: " << argument << " (expected LazySMP or YBWC)" << std::endl;
+                std::exit(1);
+            }
+
+            continue;
+        }
+
+        if(name == "Fen") {
+
+            fen = value;
+
+            continue;
+        }
+
+        char *end = nullptr;
+        unsigned long number = std::strtoul(value.c_str(), &end, 10);
+
+        if(value.empty() || *end != '\0') {
+
+            std::cerr << "Invalid option: " << argument << " (expected Name=value)" << std::endl;
+            std::exit(1);
+        }
+
+        if(name == "Hash") {
+
+            hash = number;
+        }
+        else if(name == "Threads") {
+
+            threads = std::min(std::max(number, 1ul), 255ul);
+        }
+        else if(name == "Depth") {
+
+            limits.depth = static_cast<uint8_t>(std::min(std::max(number, 1ul), 255ul));
+        }
+        else if(name == "Nodes") {
+
+            limits.nodes = number;
+        }
+        else if(name == "MoveTime") {
+
+            limits.moveTime = number;
+        }
+        else {
+
+            std::cerr << "Unknown option: " << argument << std::endl;
+            std::exit(1);
+        }
+    }
+}
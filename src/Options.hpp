@@ -0,0 +1,53 @@
+/**
+ * Redfish is an open-source chess engine.
+ * Copyright (C) 2016 Arne Groskurth
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+#include "Constants.hpp"
+#include "SearchLimits.hpp"
+
+
+/**
+ * Engine options given as "Name=value" command line arguments (e.g. "Hash=256").
+ */
+struct Options {
+
+    // transposition table (or perft cache) size in megabytes as given, 0 disables the perft cache and the engines use at least 1
+    size_t hash = 16;
+
+    // number of search threads
+    size_t threads = 1;
+
+    // how several threads share the search
+    ParallelSearch parallelSearch = ParallelSearch::LAZY_SMP;
+
+    // limits of each search
+    SearchLimits limits;
+
+    // position to start from in FEN notation, the initial position if empty
+    std::string fen;
+
+
+    /**
+     * Reads options from the given command line arguments. Exits on unknown or malformed options.
+     */
+    void parse(int argc, char **argv);
+};
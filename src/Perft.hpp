@@ -0,0 +1,222 @@
+/**
+ * Redfish is an open-source chess engine.
+ * Copyright (C) 2016 Arne Groskurth
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "Board.hpp"
+#include "Constants.hpp"
+#include "Move.hpp"
+#include "MoveGenerator.hpp"
+#include "WorkStealingPool.hpp"
+
+
+/**
+ * Counts the leaf nodes of the move tree up to a fixed depth to check and time move generation and move making.
+ *
+ * Moves are the pseudo-legal moves of the engine: positions in which a king has been captured have no moves and
+ * castling and en passant captures are not generated, so counts differ from the published perft numbers of chess.
+ *
+ * The last ply is bulk counted from the size of the generated move list. Subtree counts can be cached by position
+ * and depth in a table shared by all threads.
+ */
+class Perft {
+
+protected:
+
+    /**
+     * Cached subtree count. Written and read without locks: check is the position hash xor data so that a torn
+     * entry written concurrently by two threads fails the check and counts as a miss.
+     */
+    struct PerftCacheEntry {
+
+        std::atomic<uint64_t> check;
+
+        // count << 8 | depth
+        std::atomic<uint64_t> data;
+    };
+
+
+    std::unique_ptr<PerftCacheEntry[]> _cache;
+    uint64_t _cacheMask = 0;
+
+
+    FORCE_INLINE bool probe(uint64_t hash, uint8_t depth, uint64_t &count) const {
+
+        const PerftCacheEntry &entry = _cache[hash & _cacheMask];
+
+        uint64_t data = entry.data.load(std::memory_order_relaxed);
+
+        if((entry.check.load(std::memory_order_relaxed) ^ data) != hash || (data & 0xff) != depth) return false;
+
+        count = data >> 8;
+
+        return true;
+    }
+
+
+    FORCE_INLINE void store(uint64_t hash, uint8_t depth, uint64_t count) {
+
+        PerftCacheEntry &entry = _cache[hash & _cacheMask];
+
+        uint64_t data = (count << 8) | depth;
+
+        entry.check.store(hash ^ data, std::memory_order_relaxed);
+        entry.data.store(data, std::memory_order_relaxed);
+    }
+
+
+    /**
+     * moves - one moves array per remaining ply
+     */
+    template<bool useCache>
+    uint64_t count(Board &board, uint8_t depth, MoveGenerator::TMovesArray *moves) {
+
+        if(depth == 0) return 1;
+
+        if(board.isFinalState()) return 0;
+
+        uint64_t nodes;
+
+        // cache hits skip move generation, the last ply is bulk counted and not cached
+        if(useCache && depth > 1 && probe(board.getHash(), depth, nodes)) return nodes;
+
+        MoveGenerator moveGenerator(*moves);
+
+        moveGenerator.generateMoves(board);
+
+        // bulk counting: the moves of the last ply need not be made
+        if(depth == 1) return moveGenerator.getTotalMoveCount();
+
+        nodes = 0;
+
+        Board::Undo undo;
+
+        while(!moveGenerator.empty()) {
+
+            board.makeMove(*moveGenerator, undo);
+
+            nodes += count<useCache>(board, depth - 1, moves + 1);
+
+            board.unmakeMove(*moveGenerator, undo);
+
+            ++moveGenerator;
+        }
+
+        if(useCache) store(board.getHash(), depth, nodes);
+
+        return nodes;
+    }
+
+
+public:
+
+    /**
+     * cacheSizeMB - size of the subtree count cache in megabytes, 0 disables it
+     */
+    explicit Perft(size_t cacheSizeMB) {
+
+        if(cacheSizeMB) {
+
+            uint64_t entryCount = 1;
+
+            while(entryCount * 2 * sizeof(PerftCacheEntry) <= (cacheSizeMB << 20)) {
+
+                entryCount *= 2;
+            }
+
+            _cache.reset(new PerftCacheEntry[entryCount]());
+            _cacheMask = entryCount - 1;
+        }
+    }
+
+
+    /**
+     * Counts the leaf nodes below each move of the given position.
+     * Root moves are searched in parallel as tasks of a work-stealing pool with the given number of threads.
+     *
+     * @return Root moves and their leaf node counts in move generation order.
+     */
+    std::vector<std::pair<Move, uint64_t>> divide(const Board &board, uint8_t depth, size_t threads = 1) {
+
+        std::vector<std::pair<Move, uint64_t>> results;
+
+        if(depth == 0) return results;
+
+        MoveGenerator::TMovesArray rootMoves;
+        MoveGenerator moveGenerator(rootMoves);
+        Board rootBoard(board);
+
+        if(!rootBoard.isFinalState()) {
+
+            moveGenerator.generateMoves(rootBoard);
+        }
+
+        for(; !moveGenerator.empty(); ++moveGenerator) {
+
+            results.emplace_back(*moveGenerator, 0);
+        }
+
+        WorkStealingPool pool(threads);
+        TaskGroup group;
+
+        for(auto &result : results) {
+
+            pool.submit(group, 0, [this, &board, &result, depth](size_t) {
+
+                Board childBoard(board);
+                std::vector<MoveGenerator::TMovesArray> moves(depth);
+
+                childBoard.applyMove(result.first);
+
+                result.second = _cache ? count<true>(childBoard, depth - 1, moves.data()) : count<false>(childBoard, depth - 1, moves.data());
+            });
+        }
+
+        while(group.pendingTasks.load() > 0) {
+
+            if(!pool.runTask(group, 0)) std::this_thread::yield();
+        }
+
+        return results;
+    }
+
+
+    /**
+     * @return Leaf nodes of the move tree of the given depth.
+     */
+    uint64_t perft(const Board &board, uint8_t depth, size_t threads = 1) {
+
+        if(depth == 0) return 1;
+
+        uint64_t nodes = 0;
+
+        for(auto &result : divide(board, depth, threads)) {
+
+            nodes += result.second;
+        }
+
+        return nodes;
+    }
+};
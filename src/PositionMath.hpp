@@ -112,6 +112,19 @@ FORCE_INLINE uint8_t sq8x8BySq0x88(uint8_t sq0x88) {
     return (sq0x88 + (sq0x88 & 7)) >> 1;
 }
 
+/**
+ * Returns the sq8x8 of the least significant set bit and clears it in the given mask.
+ * Used to serialize bitboards. The given mask must not be empty.
+ */
+FORCE_INLINE uint8_t popSq8x8(uint64_t &mask8x8) {
+
+    uint8_t sq8x8 = __builtin_ctzll(mask8x8);
+
+    mask8x8 &= mask8x8 - 1;
+
+    return sq8x8;
+}
+
 
 FORCE_INLINE uint8_t rowByMask8x8(uint64_t mask8x8) {
 
@@ -160,6 +173,27 @@ FORCE_INLINE uint64_t mask8x8BySq0x88(uint8_t sq0x88) {
     return mask8x8ByRowAndColumn(rowBySq0x88(sq0x88), columnBySq0x88(sq0x88));
 }
 
+FORCE_INLINE constexpr uint64_t mask8x8ByRow(uint8_t row) {
+
+    return uint64_t(0xff) << (8 * row);
+}
+
+FORCE_INLINE constexpr uint64_t mask8x8ByColumn(uint8_t column) {
+
+    return uint64_t(0x0101010101010101) << column;
+}
+
+
+/**
+ * Moves every field of the given mask8x8 by the given sq8x8 delta (positive towards h8).
+ * Fields shifted off the board are dropped, wrapping around columns has to be masked by the caller.
+ */
+template<int8_t delta8x8>
+FORCE_INLINE constexpr uint64_t shiftMask8x8(uint64_t mask8x8) {
+
+    return (delta8x8 > 0) ? (mask8x8 << (delta8x8 & 63)) : (mask8x8 >> (-delta8x8 & 63));
+}
+
 
 FORCE_INLINE bool sq0x88Valid(uint8_t sq0x88) {
 
@@ -0,0 +1,106 @@
+/**
+ * Redfish is an open-source chess engine.
+ * Copyright (C) 2016 Arne Groskurth
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Profiler.hpp"
+
+#ifdef PROFILE
+
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+
+
+static const char *sectionNames[PROFILER_SECTION_COUNT] = {
+    "generate moves",
+    "apply move",
+    "unmake move",
+    "evaluate",
+    "probe transposition table"
+};
+
+
+/**
+ * Totals of all exited threads, printed when destroyed at program exit.
+ */
+struct ProfilerTotals {
+
+    std::mutex mutex;
+    ProfilerCounters counters;
+
+    ~ProfilerTotals() {
+
+        uint64_t totalTicks = 0;
+
+        for(uint64_t ticks : counters.ticks) {
+
+            totalTicks += ticks;
+        }
+
+        std::cerr << "Profile (ticks are cpu cycles on x86, nanoseconds elsewhere):" << std::endl;
+
+        for(uint8_t section = 0; section < PROFILER_SECTION_COUNT; section++) {
+
+            uint64_t calls = counters.calls[section];
+            uint64_t ticks = counters.ticks[section];
+
+            std::cerr << "  " << std::left << std::setw(28) << sectionNames[section] << std::right
+                << std::setw(14) << calls << " calls"
+                << std::setw(16) << ticks << " ticks"
+                << std::setw(10) << (calls ? ticks / calls : 0) << " per call"
+                << std::setw(6) << (totalTicks ? 100 * ticks / totalTicks : 0) << "%" << std::endl;
+        }
+    }
+};
+
+
+/**
+ * Constructed on first use by a thread's counters and thus destroyed only after them.
+ */
+static ProfilerTotals &getTotals() {
+
+    static ProfilerTotals totals;
+
+    return totals;
+}
+
+
+Profiler::ThreadCounters::ThreadCounters() {
+
+    getTotals();
+}
+
+
+Profiler::ThreadCounters::~ThreadCounters() {
+
+    merge(counters);
+}
+
+
+void Profiler::merge(const ProfilerCounters &counters) {
+
+    ProfilerTotals &totals = getTotals();
+    std::lock_guard<std::mutex> lock(totals.mutex);
+
+    for(uint8_t section = 0; section < PROFILER_SECTION_COUNT; section++) {
+
+        totals.counters.calls[section] += counters.calls[section];
+        totals.counters.ticks[section] += counters.ticks[section];
+    }
+}
+
+#endif
@@ -0,0 +1,151 @@
+/**
+ * Redfish is an open-source chess engine.
+ * Copyright (C) 2016 Arne Groskurth
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+#include "Constants.hpp"
+
+#ifdef PROFILE
+
+#include <array>
+#include <chrono>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#endif
+
+
+/**
+ * Hot paths timed by the profiler.
+ */
+enum ProfilerSection : uint8_t {
+
+    GENERATE_MOVES,
+    APPLY_MOVE,
+    UNMAKE_MOVE,
+    EVALUATE,
+    PROBE_TRANSPOSITION_TABLE,
+    PROFILER_SECTION_COUNT
+};
+
+
+/**
+ * Times the rest of the enclosing scope as the given ProfilerSection if compiled with -DPROFILE (see "make profile").
+ * Expands to nothing otherwise so that release builds do not pay for the instrumentation.
+ */
+#ifdef PROFILE
+#define PROFILE_SCOPE(SECTION) ScopedTimer scopedTimer(ProfilerSection::SECTION)
+#else
+#define PROFILE_SCOPE(SECTION)
+#endif
+
+
+#ifdef PROFILE
+
+/**
+ * Time stamp counter ticks (cpu cycles) on x86, steady clock nanoseconds elsewhere.
+ */
+FORCE_INLINE uint64_t readTimestamp() {
+
+#if defined(__x86_64__) || defined(__i386__)
+
+    return __rdtsc();
+
+#else
+
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+
+#endif
+}
+
+
+/**
+ * Calls and ticks spent per section.
+ */
+struct ProfilerCounters {
+
+    std::array<uint64_t, PROFILER_SECTION_COUNT> calls{};
+    std::array<uint64_t, PROFILER_SECTION_COUNT> ticks{};
+};
+
+
+/**
+ * Collects the counters of all threads. Every thread accumulates into its own table without synchronization, tables
+ * are merged into the totals when their thread exits and the breakdown is printed to stderr at program exit.
+ */
+class Profiler {
+
+protected:
+
+    struct ThreadCounters {
+
+        ProfilerCounters counters;
+
+        ThreadCounters();
+        ~ThreadCounters();
+    };
+
+
+public:
+
+    /**
+     * @return Counters of the calling thread.
+     */
+    static FORCE_INLINE ProfilerCounters &getThreadCounters() {
+
+        static thread_local ThreadCounters threadCounters;
+
+        return threadCounters.counters;
+    }
+
+    /**
+     * Adds the counters of an exiting thread to the totals.
+     */
+    static void merge(const ProfilerCounters &counters);
+};
+
+
+/**
+ * Adds the ticks from its construction to its destruction to the given section of the calling thread.
+ */
+class ScopedTimer {
+
+protected:
+
+    ProfilerSection _section;
+    uint64_t _start;
+
+
+public:
+
+    FORCE_INLINE explicit ScopedTimer(ProfilerSection section) : _section(section), _start(readTimestamp()) {}
+
+    FORCE_INLINE ~ScopedTimer() {
+
+        ProfilerCounters &counters = Profiler::getThreadCounters();
+
+        counters.ticks[_section] += readTimestamp() - _start;
+        counters.calls[_section]++;
+    }
+};
+
+#endif
@@ -18,26 +18,20 @@
 
 #pragma once
 
-#include <algorithm>
-#include <iterator>
+#include <cstdint>
 
-#include "Move.hpp"
-#include "MoveGenerator.hpp"
 
+/**
+ * Bounds of a single search. Zero disables the node and time limits.
+ */
+struct SearchLimits {
 
-class SortedMoveGenerator : public MoveGenerator {
-
-public:
-
-    FORCE_INLINE TMovesArray::size_type generateMoves(Board &board) {
-
-        MoveGenerator::generateMoves(board);
-
-        std::sort(_moves.begin(), std::next(_moves.begin(), _totalMoveCount), [](const Move &move1, const Move &move2) {
+    // maximum depth of iterative deepening in plies
+    uint8_t depth = 6;
 
-            return move1.capturedPieceType < move2.capturedPieceType;
-        });
+    // node budget
+    uint64_t nodes = 0;
 
-        return _totalMoveCount;
-    }
-};
\ No newline at end of file
+    // wall-clock budget in milliseconds
+    uint64_t moveTime = 0;
+};
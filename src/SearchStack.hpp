@@ -0,0 +1,82 @@
+/**
+ * Redfish is an open-source chess engine.
+ * Copyright (C) 2016 Arne Groskurth
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "Board.hpp"
+#include "Constants.hpp"
+#include "Move.hpp"
+#include "MoveGenerator.hpp"
+#include "MovePicker.hpp"
+
+
+/**
+ * Maximum search depth in plies.
+ */
+const uint8_t maxPly = 128;
+
+
+/**
+ * Search state of a single ply.
+ */
+struct SearchStackEntry {
+
+    // moves generated at this ply and their ordering scores
+    MoveGenerator::TMovesArray moves;
+    MovePicker::TScoresArray scores;
+
+    // quiet moves that caused beta cutoffs at this ply
+    MovePicker::TKillersArray killers;
+
+    // undo record of the move currently searched at this ply
+    Board::Undo undo;
+
+    // whether the move currently searched at this ply is a null move
+    bool nullMove;
+
+    // principal variation found below this ply
+    std::array<Move, maxPly> principalVariation;
+    uint8_t principalVariationLength;
+};
+
+
+/**
+ * Preallocated per-thread search state indexed by ply.
+ * Keeps move lists off the machine stack and in a contiguous block that stays in cache across recursion.
+ */
+class SearchStack {
+
+protected:
+
+    std::vector<SearchStackEntry> _entries;
+
+
+public:
+
+    SearchStack() : _entries(maxPly + 1) {}
+
+
+    FORCE_INLINE SearchStackEntry &operator[](uint8_t ply) {
+
+        return _entries[ply];
+    }
+};
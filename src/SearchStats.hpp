@@ -0,0 +1,158 @@
+/**
+ * Redfish is an open-source chess engine.
+ * Copyright (C) 2016 Arne Groskurth
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <iostream>
+
+#include "SearchStack.hpp"
+
+
+/**
+ * Counters of a single search. Every thread fills its own instance, the main engine merges them once the search is
+ * done so that counting never touches shared cache lines.
+ */
+struct SearchStats {
+
+    // moves the staged picker generated per interior node until it ran out of moves or a cutoff stopped it (later stages
+    // are never generated), counted in buckets of this width, the last bucket takes all larger counts
+    static const uint8_t generatedMovesBucketWidth = 8;
+    static const uint8_t generatedMovesBucketCount = 8;
+
+    // all nodes (quiescence nodes included)
+    uint64_t nodes = 0;
+    uint64_t quiescenceNodes = 0;
+
+    uint64_t transpositionTableProbes = 0;
+    uint64_t transpositionTableHits = 0;
+    uint64_t transpositionTableCutoffs = 0;
+
+    // beta cutoffs by a searched move and how many of them by the first move of the node
+    uint64_t betaCutoffs = 0;
+    uint64_t firstMoveCutoffs = 0;
+
+    // nodes of all threads searched by each completed iteration (filled by the main engine)
+    std::array<uint64_t, maxPly + 1> iterationNodes{};
+    uint8_t completedDepth = 0;
+
+    std::array<uint64_t, generatedMovesBucketCount> generatedMoves{};
+
+    // wall-clock time of the search in microseconds
+    uint64_t microseconds = 0;
+
+
+    FORCE_INLINE void countGeneratedMoves(size_t moveCount) {
+
+        generatedMoves[std::min(moveCount / generatedMovesBucketWidth, size_t(generatedMovesBucketCount - 1))]++;
+    }
+
+
+    /**
+     * Adds the counters of another thread of the same search.
+     */
+    void merge(const SearchStats &other) {
+
+        nodes += other.nodes;
+        quiescenceNodes += other.quiescenceNodes;
+
+        transpositionTableProbes += other.transpositionTableProbes;
+        transpositionTableHits += other.transpositionTableHits;
+        transpositionTableCutoffs += other.transpositionTableCutoffs;
+
+        betaCutoffs += other.betaCutoffs;
+        firstMoveCutoffs += other.firstMoveCutoffs;
+
+        for(size_t i = 0; i < generatedMoves.size(); i++) {
+
+            generatedMoves[i] += other.generatedMoves[i];
+        }
+    }
+
+
+    uint64_t getNodesPerSecond() const {
+
+        return microseconds ? nodes * 1000000 / microseconds : 0;
+    }
+
+    double getTranspositionTableHitRate() const {
+
+        return transpositionTableProbes ? double(transpositionTableHits) / transpositionTableProbes : 0;
+    }
+
+    double getFirstMoveCutoffRate() const {
+
+        return betaCutoffs ? double(firstMoveCutoffs) / betaCutoffs : 0;
+    }
+
+    /**
+     * @return Nodes of the given iteration divided by the nodes of the previous one, 0 if there is no previous count or
+     * the ratio is below 1 (transposition table hits from the previous iteration cut the tree, so it is no branching factor).
+     */
+    double getEffectiveBranchingFactor(uint8_t depth) const {
+
+        double ratio = (depth > 1 && iterationNodes[depth - 1]) ? double(iterationNodes[depth]) / iterationNodes[depth - 1] : 0;
+
+        return ratio >= 1 ? ratio : 0;
+    }
+
+
+    friend std::ostream& operator<< (std::ostream &out, const SearchStats &stats) {
+
+        out << "Nodes: " << stats.nodes << " (" << stats.quiescenceNodes << " quiescence), " << stats.getNodesPerSecond() << " nps" << std::endl;
+
+        out << "Hash probes: " << stats.transpositionTableProbes << ", " << int(100 * stats.getTranspositionTableHitRate()) << "% hits, "
+            << stats.transpositionTableCutoffs << " cutoffs" << std::endl;
+
+        out << "Beta cutoffs: " << stats.betaCutoffs << ", " << int(100 * stats.getFirstMoveCutoffRate()) << "% by the first move" << std::endl;
+
+        out << "Branching factor by depth:";
+
+        for(uint8_t depth = 2; depth <= stats.completedDepth; depth++) {
+
+            double branchingFactor = stats.getEffectiveBranchingFactor(depth);
+
+            if(branchingFactor) {
+
+                out << " " << int(depth) << ":" << (int(10 * branchingFactor) / 10.0);
+            }
+        }
+
+        out << std::endl << "Moves generated per node until cutoff:";
+
+        for(uint8_t bucket = 0; bucket < generatedMovesBucketCount; bucket++) {
+
+            out << " " << (bucket * generatedMovesBucketWidth);
+
+            if(bucket + 1 < generatedMovesBucketCount) {
+
+                out << "-" << ((bucket + 1) * generatedMovesBucketWidth - 1);
+            }
+            else {
+
+                out << "+";
+            }
+
+            out << ":" << stats.generatedMoves[bucket];
+        }
+
+        return out << std::endl;
+    }
+};
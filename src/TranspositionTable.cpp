@@ -0,0 +1,232 @@
+/**
+ * Redfish is an open-source chess engine.
+ * Copyright (C) 2016 Arne Groskurth
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TranspositionTable.hpp"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+
+/**
+ * Size of a huge page on x86-64.
+ */
+static const size_t hugePageSize = 2 << 20;
+
+/**
+ * Minimum number of bytes a thread zeroes when clearing, smaller tables are not worth starting threads for.
+ */
+static const uint64_t minClearBytesPerThread = 4 << 20;
+
+
+TranspositionTable::TranspositionTable(size_t sizeMB) {
+
+    resize(sizeMB);
+}
+
+
+TranspositionTable::~TranspositionTable() {
+
+    deallocate();
+}
+
+
+void TranspositionTable::resize(size_t sizeMB) {
+
+    uint64_t bucketCount = 1;
+
+    while(bucketCount * 2 * sizeof(TranspositionTableBucket) <= (sizeMB << 20)) {
+
+        bucketCount *= 2;
+    }
+
+    deallocate();
+    allocate(bucketCount * sizeof(TranspositionTableBucket));
+
+    _bucketMask = bucketCount - 1;
+
+    clear(std::max(1u, std::thread::hardware_concurrency()));
+
+    _pageSize = detectPageSize();
+}
+
+
+void TranspositionTable::allocate(size_t size) {
+
+    void *memory;
+
+    // explicit huge pages (only available if reserved, e.g. via /proc/sys/vm/nr_hugepages)
+    if(size % hugePageSize == 0) {
+
+        memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+
+        if(memory != MAP_FAILED) {
+
+            _buckets = static_cast<TranspositionTableBucket *>(memory);
+            _allocation = Allocation::MMAP_HUGETLB;
+            _allocationSize = size;
+
+            return;
+        }
+    }
+
+    // transparent huge pages require a huge page aligned range: over-allocate and unmap the unaligned head and tail
+    if(size >= hugePageSize) {
+
+        size_t mappedSize = size + hugePageSize;
+
+        memory = mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+        if(memory != MAP_FAILED) {
+
+            uintptr_t start = reinterpret_cast<uintptr_t>(memory);
+            uintptr_t alignedStart = (start + hugePageSize - 1) & ~uintptr_t(hugePageSize - 1);
+
+            if(alignedStart > start) munmap(memory, alignedStart - start);
+            if(alignedStart + size < start + mappedSize) munmap(reinterpret_cast<void *>(alignedStart + size), start + mappedSize - alignedStart - size);
+
+            madvise(reinterpret_cast<void *>(alignedStart), size, MADV_HUGEPAGE);
+
+            _buckets = reinterpret_cast<TranspositionTableBucket *>(alignedStart);
+            _allocation = Allocation::MMAP;
+            _allocationSize = size;
+
+            return;
+        }
+    }
+
+    if(posix_memalign(&memory, alignof(TranspositionTableBucket), size) != 0) {
+
+        throw std::bad_alloc();
+    }
+
+    _buckets = static_cast<TranspositionTableBucket *>(memory);
+    _allocation = Allocation::ALIGNED_ALLOC;
+    _allocationSize = size;
+}
+
+
+void TranspositionTable::deallocate() {
+
+    if(_buckets == nullptr) return;
+
+    if(_allocation == Allocation::ALIGNED_ALLOC) {
+
+        std::free(_buckets);
+    }
+    else {
+
+        munmap(_buckets, _allocationSize);
+    }
+
+    _buckets = nullptr;
+}
+
+
+size_t TranspositionTable::detectPageSize() const {
+
+    if(_allocation == Allocation::MMAP_HUGETLB) return hugePageSize;
+
+    // the kernel reports transparent huge pages backing a mapping in /proc/self/smaps
+    std::ifstream smaps("/proc/self/smaps");
+    std::string line;
+    uintptr_t start = reinterpret_cast<uintptr_t>(_buckets);
+    bool inMapping = false;
+
+    while(std::getline(smaps, line)) {
+
+        uintptr_t mappingStart, mappingEnd;
+
+        if(std::sscanf(line.c_str(), "%" SCNxPTR "-%" SCNxPTR " ", &mappingStart, &mappingEnd) == 2 && line.find(':') > line.find(' ')) {
+
+            inMapping = mappingStart <= start && start < mappingEnd;
+        }
+        else if(inMapping && line.compare(0, 14, "AnonHugePages:") == 0) {
+
+            return (std::strtoul(line.c_str() + 14, nullptr, 10) > 0) ? hugePageSize : size_t(sysconf(_SC_PAGESIZE));
+        }
+    }
+
+    return size_t(sysconf(_SC_PAGESIZE));
+}
+
+
+unsigned TranspositionTable::getFillRate() const {
+
+    unsigned used = 0;
+
+    for(uint64_t bucket = 0; bucket < std::min(uint64_t(250), _bucketMask + 1); bucket++) {
+
+        for(const TranspositionTableEntry &entry : _buckets[bucket].entries) {
+
+            TranspositionTableData data = entry.peek();
+
+            used += !data.isEmpty() && data.getAge() == _age;
+        }
+    }
+
+    return used * 1000 / (std::min(uint64_t(250), _bucketMask + 1) * 4);
+}
+
+
+void TranspositionTable::clear(unsigned threadCount) {
+
+    uint64_t bucketCount = _bucketMask + 1;
+    uint64_t maxThreadCount = std::max(bucketCount * sizeof(TranspositionTableBucket) / minClearBytesPerThread, uint64_t(1));
+
+    threadCount = static_cast<unsigned>(std::min<uint64_t>(std::max(threadCount, 1u), maxThreadCount));
+
+    if(threadCount == 1) {
+
+        std::memset(static_cast<void *>(_buckets), 0, bucketCount * sizeof(TranspositionTableBucket));
+    }
+    else {
+
+        uint64_t bucketsPerThread = (bucketCount + threadCount - 1) / threadCount;
+
+        std::vector<std::thread> threads;
+
+        // every thread zeroes a contiguous range of buckets (atomics of zero are all-zero bytes)
+        for(uint64_t firstBucket = 0; firstBucket < bucketCount; firstBucket += bucketsPerThread) {
+
+            uint64_t count = std::min(bucketsPerThread, bucketCount - firstBucket);
+
+            threads.emplace_back([this, firstBucket, count]() {
+
+                std::memset(static_cast<void *>(_buckets + firstBucket), 0, count * sizeof(TranspositionTableBucket));
+            });
+        }
+
+        for(std::thread &thread : threads) {
+
+            thread.join();
+        }
+    }
+
+    _age = 0;
+}
@@ -0,0 +1,306 @@
+/**
+ * Redfish is an open-source chess engine.
+ * Copyright (C) 2016 Arne Groskurth
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+#include "Constants.hpp"
+#include "Move.hpp"
+#include "PositionMath.hpp"
+#include "Profiler.hpp"
+
+
+/**
+ * Kind of value stored in a transposition table entry.
+ */
+enum Bound : uint8_t {
+
+    NO_BOUND    = 0b00,
+    UPPER_BOUND = 0b01,     // value <= alpha: no move raised alpha
+    LOWER_BOUND = 0b10,     // value >= beta: search failed high
+    EXACT       = 0b11
+};
+
+
+/**
+ * Decoded content of a transposition table entry.
+ *
+ * bits     description of _data
+ * 0-31     value
+ * 32-47    best move (packed, 0 for none)
+ * 48-55    depth
+ * 56-57    bound
+ * 58-63    age
+ */
+class TranspositionTableData {
+
+protected:
+
+    uint64_t _data = 0;
+
+
+public:
+
+    TranspositionTableData() {}
+    explicit TranspositionTableData(uint64_t data) : _data(data) {}
+
+    /**
+     * Values beyond 32bit are saturated which keeps bounds valid.
+     */
+    TranspositionTableData(int64_t value, uint16_t packedMove, uint8_t depth, Bound bound, uint8_t age) {
+
+        if(value > std::numeric_limits<int32_t>::max()) value = std::numeric_limits<int32_t>::max();
+        if(value < std::numeric_limits<int32_t>::min()) value = std::numeric_limits<int32_t>::min();
+
+        _data = uint64_t(uint32_t(int32_t(value)))
+            | (uint64_t(packedMove) << 32)
+            | (uint64_t(depth) << 48)
+            | (uint64_t(bound) << 56)
+            | (uint64_t(age & 0b111111) << 58);
+    }
+
+    FORCE_INLINE uint64_t getRaw() const { return _data; }
+    FORCE_INLINE int64_t getValue() const { return static_cast<int32_t>(_data & 0xFFFFFFFF); }
+    FORCE_INLINE uint16_t getPackedMove() const { return static_cast<uint16_t>(_data >> 32); }
+    FORCE_INLINE uint8_t getDepth() const { return static_cast<uint8_t>(_data >> 48); }
+    FORCE_INLINE Bound getBound() const { return static_cast<Bound>((_data >> 56) & 0b11); }
+    FORCE_INLINE uint8_t getAge() const { return static_cast<uint8_t>(_data >> 58); }
+
+    FORCE_INLINE bool isEmpty() const { return getBound() == Bound::NO_BOUND; }
+    FORCE_INLINE bool hasMove() const { return getPackedMove() != 0; }
+
+
+    FORCE_INLINE Move getMove() const { return Move(getPackedMove()); }
+};
+
+
+/**
+ * A single transposition table entry of 16 bytes that can be read and written concurrently without locks.
+ *
+ * The key is stored XORed with the data. Both words are accessed atomically but not as a whole, so a concurrent
+ * write may tear an entry. A torn entry does not verify against any key and is treated as a miss.
+ */
+class TranspositionTableEntry {
+
+protected:
+
+    std::atomic<uint64_t> _keyXorData;
+    std::atomic<uint64_t> _data;
+
+
+public:
+
+    /**
+     * @return Whether the entry holds data for the given key. Copies the data if so.
+     */
+    FORCE_INLINE bool read(uint64_t key, TranspositionTableData &data) const {
+
+        uint64_t rawData = _data.load(std::memory_order_relaxed);
+        uint64_t keyXorData = _keyXorData.load(std::memory_order_relaxed);
+
+        if((keyXorData ^ rawData) != key) return false;
+
+        data = TranspositionTableData(rawData);
+
+        return !data.isEmpty();
+    }
+
+    /**
+     * @return Data regardless of the stored key (used to decide on replacement only).
+     */
+    FORCE_INLINE TranspositionTableData peek() const {
+
+        return TranspositionTableData(_data.load(std::memory_order_relaxed));
+    }
+
+    FORCE_INLINE void write(uint64_t key, const TranspositionTableData &data) {
+
+        _keyXorData.store(key ^ data.getRaw(), std::memory_order_relaxed);
+        _data.store(data.getRaw(), std::memory_order_relaxed);
+    }
+};
+
+
+/**
+ * Four entries sharing one cache line.
+ */
+struct alignas(64) TranspositionTableBucket {
+
+    std::array<TranspositionTableEntry, 4> entries;
+};
+
+
+/**
+ * Fixed-size hash table of searched positions.
+ * Every position maps to one bucket so that a lookup costs at most one cache miss.
+ */
+class TranspositionTable {
+
+protected:
+
+    TranspositionTableBucket *_buckets = nullptr;
+    uint64_t _bucketMask = 0;
+
+    // how the buckets have been allocated
+    enum Allocation : uint8_t {
+
+        ALIGNED_ALLOC,      // posix_memalign() with regular pages
+        MMAP,               // mmap() with madvise(MADV_HUGEPAGE) asking for transparent huge pages
+        MMAP_HUGETLB        // mmap() with MAP_HUGETLB from the reserved huge page pool
+    };
+
+    Allocation _allocation = Allocation::ALIGNED_ALLOC;
+    size_t _allocationSize = 0;
+    size_t _pageSize = 0;
+
+    // incremented with every search to prefer replacing entries of former searches
+    uint8_t _age = 0;
+
+
+    FORCE_INLINE TranspositionTableBucket &getBucket(uint64_t hash) const {
+
+        return _buckets[hash & _bucketMask];
+    }
+
+
+    void allocate(size_t size);
+    void deallocate();
+    size_t detectPageSize() const;
+
+
+public:
+
+    /**
+     * Allocates a table of at most the given size in megabytes (rounded down to a power of two buckets).
+     * Huge pages are used if available to reduce TLB misses on lookups.
+     */
+    explicit TranspositionTable(size_t sizeMB);
+    ~TranspositionTable();
+
+    TranspositionTable(const TranspositionTable &) = delete;
+    TranspositionTable &operator=(const TranspositionTable &) = delete;
+
+
+    /**
+     * Reallocates the table with the given size in megabytes. Drops all entries.
+     */
+    void resize(size_t sizeMB);
+
+    /**
+     * Drops all entries. Tables of several megabytes are cleared by up to the given number of threads, each zeroing at least 4 MB.
+     */
+    void clear(unsigned threadCount = 1);
+
+
+    /**
+     * Has to be called before every new search.
+     */
+    FORCE_INLINE void newSearch() {
+
+        _age = (_age + 1) & 0b111111;
+    }
+
+
+    /**
+     * @return Whether an entry is stored for the given hash. Copies its data if so.
+     * Safe to call concurrently with store().
+     */
+    FORCE_INLINE bool probe(uint64_t hash, TranspositionTableData &data) const {
+
+        PROFILE_SCOPE(PROBE_TRANSPOSITION_TABLE);
+
+        for(const TranspositionTableEntry &entry : getBucket(hash).entries) {
+
+            if(entry.read(hash, data)) return true;
+        }
+
+        return false;
+    }
+
+
+    /**
+     * Stores a search result. Safe to call concurrently with probe() and store().
+     *
+     * Replacement policy (depth-preferred):
+     *  - an entry of the same position gets replaced unless it has been searched deeper in the current search
+     *  - otherwise the entry of the oldest search gets replaced, ties are broken by lowest depth
+     */
+    FORCE_INLINE void store(uint64_t hash, int64_t value, const Move &move, bool hasMove, uint8_t depth, Bound bound) {
+
+        TranspositionTableBucket &bucket = getBucket(hash);
+        TranspositionTableEntry *replace = &bucket.entries[0];
+        int replaceScore = std::numeric_limits<int>::max();
+        uint16_t packedMove = hasMove ? move.getPacked() : 0;
+
+        for(TranspositionTableEntry &entry : bucket.entries) {
+
+            TranspositionTableData data;
+
+            if(entry.read(hash, data)) {
+
+                if(depth < data.getDepth() && data.getAge() == _age && bound != Bound::EXACT) return;
+
+                // keep known best move if none given
+                entry.write(hash, TranspositionTableData(value, hasMove ? packedMove : data.getPackedMove(), depth, bound, _age));
+
+                return;
+            }
+
+            data = entry.peek();
+
+            int score = data.isEmpty() ? std::numeric_limits<int>::min() : (int(data.getDepth()) - 256 * ((_age - data.getAge()) & 0b111111));
+
+            if(score < replaceScore) {
+
+                replace = &entry;
+                replaceScore = score;
+            }
+        }
+
+        replace->write(hash, TranspositionTableData(value, packedMove, depth, bound, _age));
+    }
+
+
+    /**
+     * @return Size of the table in bytes.
+     */
+    FORCE_INLINE size_t getSize() const {
+
+        return (_bucketMask + 1) * sizeof(TranspositionTableBucket);
+    }
+
+
+    /**
+     * @return Size of the memory pages backing the table in bytes.
+     */
+    FORCE_INLINE size_t getPageSize() const {
+
+        return _pageSize;
+    }
+
+
+    /**
+     * @return Permille of entries used by the current search (sampled from the first 1000 entries).
+     */
+    unsigned getFillRate() const;
+};
@@ -0,0 +1,158 @@
+/**
+ * Redfish is an open-source chess engine.
+ * Copyright (C) 2016 Arne Groskurth
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "WorkStealingPool.hpp"
+
+#include <algorithm>
+#include <utility>
+
+
+WorkStealingPool::WorkStealingPool(size_t threads) : _queuedTasks(0) {
+
+    for(size_t workerIndex = 0; workerIndex < std::max(threads, size_t(1)); workerIndex++) {
+
+        _workers.emplace_back(new Worker());
+    }
+
+    for(size_t workerIndex = 1; workerIndex < _workers.size(); workerIndex++) {
+
+        _threads.emplace_back(&WorkStealingPool::workerLoop, this, workerIndex);
+    }
+}
+
+
+WorkStealingPool::~WorkStealingPool() {
+
+    {
+        std::lock_guard<std::mutex> lock(_idleMutex);
+
+        _shutdown = true;
+    }
+
+    _idleCondition.notify_all();
+
+    for(auto &thread : _threads) {
+
+        thread.join();
+    }
+}
+
+
+void WorkStealingPool::submit(TaskGroup &group, size_t workerIndex, TTask function) {
+
+    Worker &worker = *_workers[workerIndex];
+
+    group.pendingTasks.fetch_add(1);
+
+    {
+        std::lock_guard<std::mutex> lock(worker.mutex);
+
+        worker.tasks.push_back(Task{std::move(function), &group});
+    }
+
+    // taking the idle mutex orders this submission before a worker going to sleep and thus avoids lost wake-ups
+    {
+        std::lock_guard<std::mutex> lock(_idleMutex);
+
+        _queuedTasks.fetch_add(1);
+    }
+
+    _idleCondition.notify_one();
+}
+
+
+bool WorkStealingPool::runTask(TaskGroup &group, size_t workerIndex) {
+
+    Task task;
+
+    if(!popTask(workerIndex, group, task)) return false;
+
+    run(task, workerIndex);
+
+    return true;
+}
+
+
+bool WorkStealingPool::popTask(size_t workerIndex, const TaskGroup &group, Task &task) {
+
+    Worker &worker = *_workers[workerIndex];
+    std::lock_guard<std::mutex> lock(worker.mutex);
+
+    if(worker.tasks.empty() || worker.tasks.back().group != &group) return false;
+
+    task = std::move(worker.tasks.back());
+    worker.tasks.pop_back();
+
+    _queuedTasks.fetch_sub(1);
+
+    return true;
+}
+
+
+bool WorkStealingPool::stealTask(size_t workerIndex, Task &task) {
+
+    for(size_t offset = 1; offset < _workers.size(); offset++) {
+
+        Worker &victim = *_workers[(workerIndex + offset) % _workers.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+
+        if(victim.tasks.empty()) continue;
+
+        task = std::move(victim.tasks.front());
+        victim.tasks.pop_front();
+
+        _queuedTasks.fetch_sub(1);
+
+        return true;
+    }
+
+    return false;
+}
+
+
+void WorkStealingPool::run(Task &task, size_t workerIndex) {
+
+    TaskGroup *group = task.group;
+
+    task.function(workerIndex);
+
+    // the group may be gone as soon as its last task is done
+    group->pendingTasks.fetch_sub(1);
+}
+
+
+void WorkStealingPool::workerLoop(size_t workerIndex) {
+
+    while(true) {
+
+        Task task;
+
+        if(stealTask(workerIndex, task)) {
+
+            run(task, workerIndex);
+
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(_idleMutex);
+
+        _idleCondition.wait(lock, [this]() { return _shutdown || _queuedTasks.load() > 0; });
+
+        if(_shutdown) return;
+    }
+}
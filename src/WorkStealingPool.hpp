@@ -0,0 +1,126 @@
+/**
+ * Redfish is an open-source chess engine.
+ * Copyright (C) 2016 Arne Groskurth
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+/**
+ * Counts the unfinished tasks that have been submitted for a common join point.
+ */
+struct TaskGroup {
+
+    std::atomic<size_t> pendingTasks;
+
+    TaskGroup() : pendingTasks(0) {}
+};
+
+
+/**
+ * Thread pool running tasks from one double-ended queue per worker.
+ * Workers push and pop their own tasks at the bottom (newest first) and idle workers steal from the top of other
+ * queues (oldest first), which in a search tree are the tasks closest to the root and thus the largest ones.
+ *
+ * Worker 0 is the thread that created the pool. It only runs tasks while waiting for them in runTask().
+ */
+class WorkStealingPool {
+
+public:
+
+    // tasks are given the index of the worker running them
+    typedef std::function<void(size_t)> TTask;
+
+
+protected:
+
+    struct Task {
+
+        TTask function;
+        TaskGroup *group;
+    };
+
+    struct Worker {
+
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+
+    std::vector<std::unique_ptr<Worker>> _workers;
+    std::vector<std::thread> _threads;
+
+    // tasks queued over all workers, idle workers sleep on the condition while there are none
+    std::atomic<size_t> _queuedTasks;
+    std::mutex _idleMutex;
+    std::condition_variable _idleCondition;
+    bool _shutdown = false;
+
+
+    /**
+     * Takes the newest task of the given worker if it belongs to the given group.
+     */
+    bool popTask(size_t workerIndex, const TaskGroup &group, Task &task);
+
+    /**
+     * Takes the oldest task of any other worker.
+     */
+    bool stealTask(size_t workerIndex, Task &task);
+
+    void run(Task &task, size_t workerIndex);
+
+    void workerLoop(size_t workerIndex);
+
+
+public:
+
+    /**
+     * Starts threads - 1 workers in addition to the calling thread.
+     */
+    explicit WorkStealingPool(size_t threads);
+
+    ~WorkStealingPool();
+
+
+    size_t getThreadCount() const {
+
+        return _workers.size();
+    }
+
+
+    /**
+     * Queues a task of the given group at the bottom of the given (calling) worker's queue.
+     */
+    void submit(TaskGroup &group, size_t workerIndex, TTask function);
+
+    /**
+     * Runs the newest queued task of the given group on the calling worker.
+     * Only tasks of the group are taken so that a worker waiting for a group never runs unrelated work in between.
+     *
+     * @return Whether a task has been run.
+     */
+    bool runTask(TaskGroup &group, size_t workerIndex);
+};
@@ -3,6 +3,8 @@
 #include <cstdlib>
 #include <iostream>
 #include <bitset>
+#include <set>
+#include <utility>
 
 #include "src/Board.hpp"
 #include "src/Constants.hpp"
@@ -11,47 +13,231 @@
 #include "src/Misc.hpp"
 #include "src/Move.hpp"
 #include "src/MoveGenerator.hpp"
+#include "src/MovePicker.hpp"
+#include "src/Perft.hpp"
 #include "src/PositionMath.hpp"
-#include "src/SortedMoveGenerator.hpp"
+#include "src/SearchLimits.hpp"
+#include "src/SearchStats.hpp"
+#include "src/TranspositionTable.hpp"
 
 using namespace std::chrono;
 
 
+/**
+ * Collects all moves of the given generator as packed moves.
+ */
+std::set<uint16_t> collectMoves(MoveGenerator &moveGenerator) {
+
+    std::set<uint16_t> moves;
+
+    moveGenerator.rewind();
+
+    while(!moveGenerator.empty()) {
+
+        moves.insert((*moveGenerator).getPacked());
+
+        ++moveGenerator;
+    }
+
+    return moves;
+}
+
+
+/**
+ * Cross-checks the piece-traversing move generator against the square-pair implementation.
+ */
+bool verifyMoveGeneration(Board &board) {
+
+    MoveGenerator::TMovesArray pieceMoves;
+    MoveGenerator::TMovesArray squarePairMoves;
+    MoveGenerator pieceMoveGenerator(pieceMoves);
+    MoveGenerator squarePairMoveGenerator(squarePairMoves);
+
+    pieceMoveGenerator.generateMoves<true>(board);
+    squarePairMoveGenerator.generateMoves<false>(board);
+
+    std::set<uint16_t> moves = collectMoves(pieceMoveGenerator);
+
+    if(moves != collectMoves(squarePairMoveGenerator)) return false;
+
+
+    // the staged move picker has to hand out every move exactly once
+    MovePicker::TMovesArray pickerMoves;
+    MovePicker::TScoresArray pickerScores;
+    MovePicker::THistoryTable history = {};
+    MovePicker::TKillersArray killers = {{pieceMoves[pieceMoveGenerator.getTotalMoveCount() / 2], pieceMoves[pieceMoveGenerator.getTotalMoveCount() - 1]}};
+    MovePicker movePicker(pickerMoves, pickerScores);
+    std::multiset<uint16_t> pickedMoves;
+
+    movePicker.init(board, pieceMoves[0], killers, history);
+
+    while(!movePicker.empty()) {
+
+        pickedMoves.insert((*movePicker).getPacked());
+
+        ++movePicker;
+    }
+
+    return pickedMoves.size() == moves.size() && std::set<uint16_t>(pickedMoves.begin(), pickedMoves.end()) == moves;
+}
+
+
 int main() {
 
-    Board::initialize();
-    SortedMoveGenerator::initialize();
+    MoveGenerator::initialize();
 
     Board board;
     board.reset();
 
-    while(!board.isFinalState()) {
+
+    // perft counts of the engine's pseudo-legal moves with and without subtree cache and threads
+    Board fenBoard;
+    Perft perft(0);
+    Perft cachedPerft(16);
+
+    if(!fenBoard.setFen("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1") || fenBoard.getHash() != board.getHash()) {
+
+        std::cerr << "Invalid position set up from FEN!" << std::endl;
+
+        return 1;
+    }
+
+    // positions exceeding the limits of move generation (more than 256 moves, pawns without moves) are rejected
+    if(fenBoard.setFen("3Q1QQ1/QQ5Q/2Q4Q/Q3Q2Q/Q6Q/Q6Q/Q2Q3Q/kQ3QQK w - - 0 1") || fenBoard.setFen("PP5k/PP6/PP6/PP6/PP6/PP6/PP6/KP6 w - - 0 1")
+        || fenBoard.setFen("4k3/8/8/8/8/8/8/P3K3 w - - 0 1") || fenBoard.setFen("8/8/8/8/8/8/8/4K3 w - - 0 1")
+        || !fenBoard.setFen("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1")) {
+
+        std::cerr << "Invalid position accepted from FEN!" << std::endl;
+
+        return 1;
+    }
+
+    if(perft.perft(board, 4) != 197742 || cachedPerft.perft(fenBoard, 4, 4) != 197742) {
+
+        std::cerr << "Invalid perft count!" << std::endl;
+
+        return 1;
+    }
+
+    // midgame and endgame positions the self-play game does not reach, counted before pawn moves were generated set-wise
+    const std::pair<const char *, uint64_t> perftPositions[] = {
+
+        {"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w - - 0 1", 3570584},
+        {"r1bq1rk1/pp2nppp/2n1p3/3pP3/3P4/P1PB1N2/2Q2PPP/R1B1K2R b - - 3 10", 1280407},
+        {"6k1/5ppp/8/8/8/8/1q3PPP/3R2K1 b - - 0 1", 279331},
+        {"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 87695},
+        {"8/8/4k3/3p4/3P4/4K3/8/8 w - - 0 1", 2916},
+        {"4k3/1P4p1/8/8/8/8/1P4p1/4K3 w - - 0 1", 4788}
+    };
+
+    for(const auto &position : perftPositions) {
+
+        if(!fenBoard.setFen(position.first) || perft.perft(fenBoard, 4) != position.second || cachedPerft.perft(fenBoard, 4, 4) != position.second) {
+
+            std::cerr << "Invalid perft count for " << position.first << "!" << std::endl;
+
+            return 1;
+        }
+
+        // the position and all positions after one move
+        MoveGenerator::TMovesArray moves;
+        MoveGenerator moveGenerator(moves);
+        Board::Undo undo;
+        bool verified = verifyMoveGeneration(fenBoard);
+
+        moveGenerator.generateMoves(fenBoard);
+
+        while(verified && !moveGenerator.empty()) {
+
+            fenBoard.makeMove(*moveGenerator, undo);
+
+            verified = verifyMoveGeneration(fenBoard);
+
+            fenBoard.unmakeMove(*moveGenerator, undo);
+
+            ++moveGenerator;
+        }
+
+        if(!verified) {
+
+            std::cerr << "Unequal moves generated for " << position.first << "!" << std::endl;
+
+            return 1;
+        }
+    }
+
+    // there are no draw rules, so games where both sides keep shuffling pieces are cut off
+    while(!board.isFinalState() && board.getMoveNumber() < 150) {
 
         std::cout << "\x1B[2J\x1B[H" << mastHead << board;
 
-        Engine<true> engine1(board, 6);
-        Engine<false> engine2(board, 6);
+        if(!verifyMoveGeneration(board)) {
+
+            std::cerr << "Unequal moves generated!" << std::endl;
+
+            return 1;
+        }
+
+        // transposition table entries of deeper searches may change results so only engines with equal settings are compared
+        TranspositionTable transpositionTable1(16);
+        TranspositionTable transpositionTable3(16);
+
+        SearchLimits limits;
+        limits.depth = 6;
+
+        Engine<true> engine1(board, limits, transpositionTable1);
+        Engine<false> engine2(board, limits, transpositionTable1);
+        Engine<true, true> engine3(board, limits, transpositionTable3);
+        Engine<false, true> engine4(board, limits, transpositionTable3);
 
         high_resolution_clock::time_point t1 = high_resolution_clock::now();
         Move move1 = engine1.getBestMove();
         high_resolution_clock::time_point t2 = high_resolution_clock::now();
         Move move2 = engine2.getBestMove();
         high_resolution_clock::time_point t3 = high_resolution_clock::now();
+        Move move3 = engine3.getBestMove();
+        high_resolution_clock::time_point t4 = high_resolution_clock::now();
+        Move move4 = engine4.getBestMove();
+        high_resolution_clock::time_point t5 = high_resolution_clock::now();
 
         auto duration1 = duration_cast<microseconds>(t2 - t1).count();
         auto duration2 = duration_cast<microseconds>(t3 - t2).count();
+        auto duration3 = duration_cast<microseconds>(t4 - t3).count();
+        auto duration4 = duration_cast<microseconds>(t5 - t4).count();
 
-        std::cout << duration1 << " / " << duration2 << std::endl;
-        std::cout << move1 << " / " << move2 << std::endl;
+        std::cout << duration1 << " / " << duration2 << " / " << duration3 << " / " << duration4 << std::endl;
+        std::cout << move1 << " / " << move2 << " / " << move3 << " / " << move4 << std::endl;
+        std::cout << engine1.getSearchStats();
 
-        if(move1 != move2) {
+        if(move1 != move3 || move2 != move4) {
 
             std::cerr << "Unequal move computed!" << std::endl;
 
-            break;
+            return 1;
+        }
+
+
+        // parallel results depend on thread timing so only their validity is checked
+        TranspositionTable transpositionTable5(16);
+        Engine<> engine5(board, limits, transpositionTable5, 4);
+        Move move5 = engine5.getBestMove();
+
+        TranspositionTable transpositionTable6(16);
+        Engine<> engine6(board, limits, transpositionTable6, 4, ParallelSearch::YBWC);
+        Move move6 = engine6.getBestMove();
+
+        MoveGenerator::TMovesArray moves;
+        MoveGenerator moveGenerator(moves);
+        moveGenerator.generateMoves(board);
+
+        if(!moveGenerator.hasMove(move5) || !moveGenerator.hasMove(move6)) {
+
+            std::cerr << "Invalid move computed with multiple threads!" << std::endl;
+
+            return 1;
         }
 
-        board.applyMove(move1);
+        board.applyMove<true>(move1);
     }
 
     return 0;